@@ -31,6 +31,35 @@ add_library(ASGE UNKNOWN IMPORTED)
 add_subdirectory(Libs)
 target_link_libraries(${PROJECT_NAME} ASGE)
 
+## asset streaming runs on a worker thread
+find_package(Threads REQUIRED)
+target_link_libraries(${PROJECT_NAME} Threads::Threads)
+
+## the simulation only uses the engine's headers, never its library, so
+## the tools can link it without ASGE
+target_compile_features(Simulation PUBLIC cxx_std_17)
+target_include_directories(Simulation PUBLIC "${CMAKE_SOURCE_DIR}/Source")
+target_include_directories(
+        Simulation
+        SYSTEM
+        PUBLIC
+        "${CMAKE_SOURCE_DIR}/Libs/ASGE/include")
+target_link_libraries(Simulation PUBLIC Threads::Threads)
+target_link_libraries(${PROJECT_NAME} Simulation)
+
+## gcc 8 keeps std::filesystem in a separate library
+if(CMAKE_COMPILER_IS_GNUCC AND CMAKE_CXX_COMPILER_VERSION VERSION_LESS 9.0)
+    target_link_libraries(${PROJECT_NAME} stdc++fs)
+endif()
+
+## opt in heap allocation tracking
+if(TRACK_ALLOCATIONS)
+    target_compile_definitions(${PROJECT_NAME} PRIVATE TRACK_ALLOCATIONS)
+endif()
+
+## build the offline data tools
+add_subdirectory(Tools)
+
 ## library includes
 target_include_directories(
         ${PROJECT_NAME}
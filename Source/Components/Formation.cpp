@@ -0,0 +1,111 @@
+#include "Formation.h"
+
+#include <algorithm>
+
+// how far the formation drops each time it turns around
+const float FORMATION_DROP = 10;
+// the gap the formation keeps from each edge of the play area
+const float FORMATION_MARGIN = 20;
+
+void Formation::reset(int slots, float formation_speed, float ship_width)
+{
+  origin_x = 0;
+  origin_y = 0;
+  direction = 1;
+  speed = formation_speed;
+  slot_width = ship_width;
+  offsets_x.assign(static_cast<size_t>(slots), 0);
+  offsets_y.assign(static_cast<size_t>(slots), 0);
+  left_offset = 0;
+  right_offset = 0;
+}
+
+/**
+ *   @brief   Sets a slot's offset from the origin.
+ *   @details Also keeps track of the outermost slots, which decide when
+ *            the formation has reached the edge. Every slot counts
+ *            whether or not its ship is still alive. Slots are expected
+ *            to be placed in order, starting from the first.
+ *   @return  void
+ */
+void Formation::slot(int index, float x, float y)
+{
+  auto i = static_cast<size_t>(index);
+  offsets_x[i] = x;
+  offsets_y[i] = y;
+
+  left_offset = index == 0 ? x : std::min(left_offset, x);
+  right_offset = index == 0 ? x : std::max(right_offset, x);
+}
+
+void Formation::bounds(float width)
+{
+  area_width = width;
+}
+
+/**
+ *   @brief   Moves a formation's origin.
+ *   @details Checks the outermost ships' edges against the edges of the
+ *            play area first, turning around and dropping a step if
+ *            needed.
+ *   @return  void
+ */
+void advanceFormation(formation_snapshot& formation,
+                      float left_offset,
+                      float right_offset,
+                      float ship_width,
+                      float area_width,
+                      double delta_time)
+{
+  float left = formation.origin_x + left_offset;
+  float right = formation.origin_x + right_offset + ship_width;
+
+  float new_direction = formation.direction;
+  if (right > area_width - FORMATION_MARGIN)
+  {
+    new_direction = -1;
+  }
+  else if (left < FORMATION_MARGIN)
+  {
+    new_direction = 1;
+  }
+
+  if (new_direction != formation.direction)
+  {
+    formation.direction = new_direction;
+    formation.origin_y += FORMATION_DROP;
+  }
+  formation.origin_x +=
+    static_cast<float>(formation.direction * formation.speed * delta_time);
+}
+
+void Formation::advance(double delta_time)
+{
+  formation_snapshot motion = save();
+  advanceFormation(
+    motion, left_offset, right_offset, slot_width, area_width, delta_time);
+  restore(motion);
+}
+
+formation_snapshot Formation::save() const
+{
+  return formation_snapshot{ origin_x, origin_y, direction, speed };
+}
+
+void Formation::restore(const formation_snapshot& snapshot)
+{
+  origin_x = snapshot.origin_x;
+  origin_y = snapshot.origin_y;
+  direction = snapshot.direction;
+  speed = snapshot.speed;
+}
+
+float Formation::x(int index) const
+{
+  return origin_x + offsets_x[static_cast<size_t>(index)];
+}
+
+float Formation::y(int index) const
+{
+  return origin_y + offsets_y[static_cast<size_t>(index)];
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <vector>
+
+/**
+ *  A saved copy of where a formation is and where it is heading.
+ *  The slots are not saved, as they come from the wave.
+ */
+struct formation_snapshot
+{
+  float origin_x = 0;
+  float origin_y = 0;
+  float direction = 1;
+  float speed = 0;
+};
+
+/**
+ *  Moves a formation's origin, dropping it down a step and turning it
+ *  around whenever its outermost slots reach the edge of the play area.
+ *  Shared by Formation and the headless simulation, so both move alike.
+ *  @param [in,out] formation The formation to move
+ *  @param [in] left_offset The leftmost slot's offset from the origin
+ *  @param [in] right_offset The rightmost slot's offset from the origin
+ *  @param [in] ship_width The width of a ship in a slot
+ *  @param [in] area_width The width of the play area
+ *  @param [in] delta_time The time passed in seconds
+ */
+void advanceFormation(formation_snapshot& formation,
+                      float left_offset,
+                      float right_offset,
+                      float ship_width,
+                      float area_width,
+                      double delta_time);
+
+/**
+ *  A block of ships that moves as one.
+ *  The formation is a single origin plus a fixed offset for each slot.
+ *  Advancing it only moves the origin, so the cost of moving the block
+ *  does not depend on how many ships are in it. A slot's position is
+ *  worked out from the origin whenever it is asked for.
+ */
+class Formation
+{
+ public:
+  Formation() = default;
+  ~Formation() = default;
+
+  /**
+   *  Starts a new formation at the origin, moving right.
+   *  @param [in] slots The number of slots in the formation
+   *  @param [in] speed How fast the formation moves sideways
+   *  @param [in] ship_width The width of a ship in a slot
+   */
+  void reset(int slots, float speed, float ship_width);
+
+  /**
+   *  Places a slot relative to the formation's origin.
+   *  Slots must be placed in order, starting from the first.
+   *  @param [in] index The slot
+   *  @param [in] x The slot's offset from the origin
+   *  @param [in] y The slot's offset from the origin
+   */
+  void slot(int index, float x, float y);
+
+  /**
+   *  Sets the width of the area the formation moves across.
+   *  @param [in] width The width of the play area
+   */
+  void bounds(float width);
+
+  /**
+   *  Moves the formation, dropping it down a step and turning it around
+   *  whenever it reaches the edge of the play area.
+   *  @param [in] delta_time The time passed in seconds
+   */
+  void advance(double delta_time);
+
+  float x(int index) const;
+  float y(int index) const;
+
+  formation_snapshot save() const;
+  void restore(const formation_snapshot& snapshot);
+
+ private:
+  float origin_x = 0;
+  float origin_y = 0;
+  float direction = 1;
+  float speed = 0;
+  float slot_width = 0;
+  float area_width = 0;
+
+  std::vector<float> offsets_x;
+  std::vector<float> offsets_y;
+  float left_offset = 0;
+  float right_offset = 0;
+};
@@ -7,12 +7,17 @@ GameObject::~GameObject()
 }
 
 bool GameObject::addSpriteComponent(ASGE::Renderer* renderer,
-                                    const std::string& texture_file_name)
+                                    const std::string& texture_file_name,
+                                    TextureCache* texture_cache,
+                                    const SpriteAtlas* atlas,
+                                    ObjectPool<SpriteComponent>* pool)
 {
   free();
 
-  sprite_component = new SpriteComponent();
-  if (sprite_component->loadSprite(renderer, texture_file_name))
+  component_pool = pool;
+  sprite_component = pool ? pool->acquire() : new SpriteComponent();
+  if (sprite_component && sprite_component->loadSprite(
+        renderer, texture_file_name, texture_cache, atlas))
   {
     return true;
   }
@@ -21,10 +26,34 @@ bool GameObject::addSpriteComponent(ASGE::Renderer* renderer,
   return false;
 }
 
-void GameObject::free()
+void GameObject::dropSpriteComponent()
 {
-  delete sprite_component;
   sprite_component = nullptr;
+  component_pool = nullptr;
+}
+
+void GameObject::useSpriteComponent(SpriteComponent* component,
+                                    ObjectPool<SpriteComponent>* pool)
+{
+  free();
+  sprite_component = component;
+  component_pool = pool;
+}
+
+void GameObject::free()
+{
+  if (component_pool)
+  {
+    if (sprite_component)
+    {
+      component_pool->release(sprite_component);
+    }
+  }
+  else
+  {
+    delete sprite_component;
+  }
+  dropSpriteComponent();
 }
 
 SpriteComponent* GameObject::spriteComponent()
@@ -62,3 +91,31 @@ void GameObject::visible(bool shown)
 {
   visibility = shown;
 }
+
+object_snapshot GameObject::save()
+{
+  object_snapshot snapshot;
+  if (sprite_component && sprite_component->getSprite())
+  {
+    snapshot.x = sprite_component->getSprite()->xPos();
+    snapshot.y = sprite_component->getSprite()->yPos();
+  }
+  snapshot.direction_x = velocity.x;
+  snapshot.direction_y = velocity.y;
+  snapshot.speed = speed;
+  snapshot.visible = visibility;
+  return snapshot;
+}
+
+void GameObject::restore(const object_snapshot& snapshot)
+{
+  if (sprite_component && sprite_component->getSprite())
+  {
+    sprite_component->getSprite()->xPos(snapshot.x);
+    sprite_component->getSprite()->yPos(snapshot.y);
+  }
+  velocity.x = snapshot.direction_x;
+  velocity.y = snapshot.direction_y;
+  speed = snapshot.speed;
+  visibility = snapshot.visible;
+}
@@ -1,8 +1,23 @@
 #pragma once
 #include "SpriteComponent.h"
+#include "Utility/ObjectPool.h"
 #include "Utility/Vector2.h"
 #include <string>
 
+/**
+ *  A saved copy of an object's movement and visibility.
+ *  The sprite itself is not saved, only where it is.
+ */
+struct object_snapshot
+{
+  float x = 0;
+  float y = 0;
+  float direction_x = 0;
+  float direction_y = 0;
+  float speed = 0;
+  bool visible = true;
+};
+
 /**
  *  Objects used throughout the game.
  *  Provides a nice solid base class for objects in this game world.
@@ -27,13 +42,36 @@ class GameObject
    *  Allocates and attaches a sprite component to the object.
    *  Part of this process will attempt to load a texture file.
    *  If this fails this function will return false and the memory
-   *  allocated, freed.
+   *  allocated, freed. When a pool is given the component is taken from
+   *  it, and given back when the object is finished with it.
    *  @param [in] renderer The renderer used to perform the allocations
    *  @param [in] texture_file_name The file path to the the texture to load
+   *  @param [in] texture_cache The cache of decoded textures (optional)
+   *  @param [in] atlas The sprite atlas (optional)
+   *  @param [in] pool The pool to take the component from (optional)
    *  @return true if the component is successfully added
    */
   bool addSpriteComponent(ASGE::Renderer* renderer,
-                          const std::string& texture_file_name);
+                          const std::string& texture_file_name,
+                          TextureCache* texture_cache = nullptr,
+                          const SpriteAtlas* atlas = nullptr,
+                          ObjectPool<SpriteComponent>* pool = nullptr);
+
+  /**
+   *  Forgets the sprite component without freeing it.
+   *  Used before the component's pool is emptied in one go.
+   */
+  void dropSpriteComponent();
+
+  /**
+   *  Attaches a pooled component whose sprite is already loaded.
+   *  Used to take back a component after its pool was emptied, keeping
+   *  the texture it had rather than loading it again.
+   *  @param [in] component The component, handed out by the pool
+   *  @param [in] pool The pool to give it back to
+   */
+  void useSpriteComponent(SpriteComponent* component,
+                          ObjectPool<SpriteComponent>* pool);
 
   /**
    *  Returns the sprite componenent.
@@ -50,9 +88,23 @@ class GameObject
   bool visible();
   void visible(bool shown);
 
+  /**
+   *  Copies the object's state into a snapshot.
+   *  @return the snapshot
+   */
+  object_snapshot save();
+
+  /**
+   *  Puts the object back as it was when a snapshot was taken.
+   *  The object must already have its sprite.
+   *  @param [in] snapshot The snapshot to copy from
+   */
+  void restore(const object_snapshot& snapshot);
+
  private:
   void free();
   SpriteComponent* sprite_component = nullptr;
+  ObjectPool<SpriteComponent>* component_pool = nullptr;
   bool visibility = true;
   float speed = 0;
   vector2 velocity = vector2(0, 0);
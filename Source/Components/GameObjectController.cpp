@@ -5,6 +5,13 @@
 #include "GameObjectController.h"
 #include <math.h>
 
+// how far outside the screen the curved paths are baked
+const float TRAJECTORY_MARGIN = 64;
+// the distance between the curved paths' samples
+const float TRAJECTORY_STEP = 1;
+// the vertical gap between rows of ships on the curved paths
+const float TRAJECTORY_ROW_HEIGHT = 70;
+
 bool GameObjectController::setupObject(GameObject* object,
                                        ASGE::Renderer* renderer,
                                        const std::string& texture_file_name,
@@ -15,24 +22,50 @@ bool GameObjectController::setupObject(GameObject* object,
                                        float start_speed,
                                        float size_x,
                                        float size_y,
-                                       bool start_shown)
+                                       bool start_shown,
+                                       ObjectPool<SpriteComponent>* pool)
 {
-  if (object->addSpriteComponent(renderer, texture_file_name))
+  if (object->addSpriteComponent(renderer,
+                                 texture_file_name,
+                                 texture_cache,
+                                 sprite_atlas,
+                                 pool ? pool : component_pool))
   {
-    object->spriteComponent()->getSprite()->xPos(pos_x);
-    object->spriteComponent()->getSprite()->yPos(pos_y);
-
-    object->spriteComponent()->getSprite()->width(size_x);
-    object->spriteComponent()->getSprite()->height(size_y);
-
-    object->direction(dir_x, dir_y);
-    object->setSpeed(start_speed);
-    object->visible(start_shown);
+    resetObject(object,
+                pos_x,
+                pos_y,
+                dir_x,
+                dir_y,
+                start_speed,
+                size_x,
+                size_y,
+                start_shown);
     return true;
   }
   return false;
 }
 
+void GameObjectController::resetObject(GameObject* object,
+                                       float pos_x,
+                                       float pos_y,
+                                       float dir_x,
+                                       float dir_y,
+                                       float start_speed,
+                                       float size_x,
+                                       float size_y,
+                                       bool start_shown)
+{
+  object->spriteComponent()->getSprite()->xPos(pos_x);
+  object->spriteComponent()->getSprite()->yPos(pos_y);
+
+  object->spriteComponent()->getSprite()->width(size_x);
+  object->spriteComponent()->getSprite()->height(size_y);
+
+  object->direction(dir_x, dir_y);
+  object->setSpeed(start_speed);
+  object->visible(start_shown);
+}
+
 void GameObjectController::moveObject(GameObject* object, double delta_time)
 {
   if (object->direction().x != 0 &&
@@ -69,29 +102,79 @@ void GameObjectController::applyGravity(GameObject* object, double delta_time)
   object->spriteComponent()->getSprite()->yPos(new_y);
 }
 
-void GameObjectController::applyQuadraticTrajectory(GameObject* object,
-                                                    double delta_time,
-                                                    int ship_row)
+/**
+ *   @brief   Samples the curved paths across the screen.
+ *   @details Ships are kept on screen by moveObject, so the margin only
+ *            has to cover the small overshoot of a single step. With
+ *            one sample per pixel, interpolating stays within a tenth of
+ *            a pixel of the exact curves.
+ *   @return  void
+ */
+void GameObjectController::bakeTrajectories(size_t max_objects)
 {
-  // y = (1/10)(x-centre)^2
-  float new_y =
-    object->spriteComponent()->getSprite()->xPos() - (game_width / 2);
-  new_y *= new_y;
-  new_y /= 500;
-  new_y += static_cast<float>(ship_row * 70);
-  object->spriteComponent()->getSprite()->yPos(new_y);
+  float centre = game_width / 2;
+  // y = (1/500)(x-centre)^2
+  quadratic_path.bake(
+    [centre](float x) { return (x - centre) * (x - centre) / 500; },
+    -TRAJECTORY_MARGIN,
+    game_width + TRAJECTORY_MARGIN,
+    TRAJECTORY_STEP);
+  // y = 8sin(x/4) + 8
+  sin_path.bake([](float x) { return 8 * sinf(x / 4) + 8; },
+                -TRAJECTORY_MARGIN,
+                game_width + TRAJECTORY_MARGIN,
+                TRAJECTORY_STEP);
+
+  trajectory_xs.resize(max_objects);
+  trajectory_ys.resize(max_objects);
 }
 
-void GameObjectController::applySinTrajectory(GameObject* object,
-                                              double delta_time,
-                                              int ship_row)
+void GameObjectController::applyQuadraticTrajectory(GameObject* objects,
+                                                    const int* ship_rows,
+                                                    int count)
 {
-  // y = 8sin(x/4) + 8
-  float new_y = sin(object->spriteComponent()->getSprite()->xPos() / 4);
-  new_y *= 8;
-  new_y += 8;
-  new_y += static_cast<float>(ship_row * 70);
-  object->spriteComponent()->getSprite()->yPos(new_y);
+  applyTrajectory(quadratic_path, objects, ship_rows, count);
+}
+
+void GameObjectController::applySinTrajectory(GameObject* objects,
+                                              const int* ship_rows,
+                                              int count)
+{
+  applyTrajectory(sin_path, objects, ship_rows, count);
+}
+
+/**
+ *   @brief   Moves a batch of objects onto a baked path.
+ *   @details The objects' x positions are gathered first so the whole
+ *            batch is looked up in one pass over the table, then each
+ *            result is offset by its row and written back.
+ *   @return  void
+ */
+void GameObjectController::applyTrajectory(const TrajectoryTable& path,
+                                           GameObject* objects,
+                                           const int* ship_rows,
+                                           int count)
+{
+  auto size = static_cast<size_t>(count);
+  if (trajectory_xs.size() < size)
+  {
+    trajectory_xs.resize(size);
+    trajectory_ys.resize(size);
+  }
+
+  for (size_t i = 0; i < size; i++)
+  {
+    trajectory_xs[i] = objects[i].spriteComponent()->getSprite()->xPos();
+  }
+
+  path.evaluate(trajectory_xs.data(), trajectory_ys.data(), size);
+
+  for (size_t i = 0; i < size; i++)
+  {
+    float row_offset = static_cast<float>(ship_rows[i]) * TRAJECTORY_ROW_HEIGHT;
+    objects[i].spriteComponent()->getSprite()->yPos(trajectory_ys[i] +
+                                                    row_offset);
+  }
 }
 
 void GameObjectController::gameWidth(float width)
@@ -102,4 +185,19 @@ void GameObjectController::gameWidth(float width)
 void GameObjectController::gameHeight(float height)
 {
   game_height = height;
+}
+
+void GameObjectController::textureCache(TextureCache* cache)
+{
+  texture_cache = cache;
+}
+
+void GameObjectController::spriteAtlas(const SpriteAtlas* atlas)
+{
+  sprite_atlas = atlas;
+}
+
+void GameObjectController::componentPool(ObjectPool<SpriteComponent>* pool)
+{
+  component_pool = pool;
 }
\ No newline at end of file
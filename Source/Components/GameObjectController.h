@@ -5,7 +5,10 @@
 #ifndef SPACEINVADERS_GAMEOBJECTCONTROLLER_H
 #define SPACEINVADERS_GAMEOBJECTCONTROLLER_H
 
+#include <vector>
+
 #include "Components/GameObject.h"
+#include "Utility/TrajectoryTable.h"
 
 const float gravity = 9.18f;
 
@@ -18,6 +21,21 @@ class GameObjectController
   bool setupObject(GameObject* object,
                    ASGE::Renderer* renderer,
                    const std::string& texture_file_name,
+                   float pos_x,
+                   float pos_y,
+                   float dir_x,
+                   float dir_y,
+                   float start_speed,
+                   float size_x,
+                   float size_y,
+                   bool start_shown,
+                   ObjectPool<SpriteComponent>* pool = nullptr);
+
+  /**
+   *  Puts an object that already has a sprite back to its starting state,
+   *  keeping its texture. Used to recycle objects without reloading them.
+   */
+  void resetObject(GameObject* object,
                    float pos_x,
                    float pos_y,
                    float dir_x,
@@ -30,16 +48,48 @@ class GameObjectController
   void moveObject(GameObject* object, double delta_time);
 
   void applyGravity(GameObject* object, double delta_time);
-  void
-  applyQuadraticTrajectory(GameObject* object, double delta_time, int ship_row);
-  void applySinTrajectory(GameObject* object, double delta_time, int ship_row);
+
+  /**
+   *  Bakes the curved paths for the current game width.
+   *  Must be called after gameWidth() and before either path is applied.
+   *  @param [in] max_objects The most objects moved along a path at once
+   */
+  void bakeTrajectories(size_t max_objects);
+
+  /**
+   *  Puts a batch of objects on the quadratic or sine path, at the height
+   *  the path has at their current x position.
+   *  @param [in] objects The objects to move
+   *  @param [in] ship_rows The row each object is in, offsetting its path
+   *  @param [in] count The number of objects
+   */
+  void applyQuadraticTrajectory(GameObject* objects,
+                                const int* ship_rows,
+                                int count);
+  void applySinTrajectory(GameObject* objects, const int* ship_rows, int count);
 
   void gameWidth(float width);
   void gameHeight(float height);
+  void textureCache(TextureCache* cache);
+  void spriteAtlas(const SpriteAtlas* atlas);
+  void componentPool(ObjectPool<SpriteComponent>* pool);
 
  private:
+  TextureCache* texture_cache = nullptr;
+  const SpriteAtlas* sprite_atlas = nullptr;
+  ObjectPool<SpriteComponent>* component_pool = nullptr;
   float game_width = 0;
   float game_height = 0;
+
+  void applyTrajectory(const TrajectoryTable& path,
+                       GameObject* objects,
+                       const int* ship_rows,
+                       int count);
+
+  TrajectoryTable quadratic_path;
+  TrajectoryTable sin_path;
+  std::vector<float> trajectory_xs;
+  std::vector<float> trajectory_ys;
 };
 
 #endif // SPACEINVADERS_GAMEOBJECTCONTROLLER_H
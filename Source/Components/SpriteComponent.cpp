@@ -1,4 +1,6 @@
 #include "SpriteComponent.h"
+#include "Utility/SpriteAtlas.h"
+#include "Utility/TextureCache.h"
 #include <Engine/Renderer.h>
 
 SpriteComponent::~SpriteComponent()
@@ -7,12 +9,29 @@ SpriteComponent::~SpriteComponent()
 }
 
 bool SpriteComponent::loadSprite(ASGE::Renderer* renderer,
-                                 const std::string& texture_file_name)
+                                 const std::string& texture_file_name,
+                                 TextureCache* texture_cache,
+                                 const SpriteAtlas* atlas)
 {
-  free();
-  sprite = renderer->createRawSprite();
+  if (!sprite)
+  {
+    sprite = renderer->createRawSprite();
+  }
+
+  if (loadFromAtlas(texture_file_name, atlas))
+  {
+    return true;
+  }
+
+  if (texture_cache && texture_cache->load(sprite, texture_file_name))
+  {
+    useWholeTexture();
+    return true;
+  }
+
   if (sprite->loadTexture(texture_file_name))
   {
+    useWholeTexture();
     return true;
   }
 
@@ -20,6 +39,52 @@ bool SpriteComponent::loadSprite(ASGE::Renderer* renderer,
   return false;
 }
 
+/**
+ *   @brief   Points the sprite at its region of the sprite atlas.
+ *   @details All sprites on an atlas page share one texture, so the
+ *            renderer can batch them together. The sprite's dimensions
+ *            are set to the region's, matching loading the image alone.
+ *   @return  False if there is no atlas or the image is not in it.
+ */
+bool SpriteComponent::loadFromAtlas(const std::string& texture_file_name,
+                                    const SpriteAtlas* atlas)
+{
+  if (!atlas)
+  {
+    return false;
+  }
+
+  const AtlasRegion* region = atlas->find(texture_file_name);
+  if (!region || !sprite->loadTexture(atlas->pageFile(region->page)))
+  {
+    return false;
+  }
+
+  float* src_rect = sprite->srcRect();
+  src_rect[0] = static_cast<float>(region->x);
+  src_rect[1] = static_cast<float>(region->y);
+  src_rect[2] = static_cast<float>(region->width);
+  src_rect[3] = static_cast<float>(region->height);
+  sprite->width(static_cast<float>(region->width));
+  sprite->height(static_cast<float>(region->height));
+  return true;
+}
+
+/**
+ *   @brief   Draws the whole of the sprite's texture.
+ *   @details A reused sprite may still have the source rectangle of the
+ *            atlas region it was last given.
+ *   @return  void
+ */
+void SpriteComponent::useWholeTexture()
+{
+  float* src_rect = sprite->srcRect();
+  src_rect[0] = 0;
+  src_rect[1] = 0;
+  src_rect[2] = static_cast<float>(sprite->getTexture()->getWidth());
+  src_rect[3] = static_cast<float>(sprite->getTexture()->getHeight());
+}
+
 void SpriteComponent::free()
 {
   if (sprite)
@@ -1,6 +1,10 @@
 #pragma once
 #include "Utility/Rect.h"
 #include <Engine/Sprite.h>
+
+class SpriteAtlas;
+class TextureCache;
+
 /**
  *  Sprite Components are used by GameObjects
  *  A component based approach allows GameObjects to decide
@@ -26,13 +30,21 @@ class SpriteComponent
    *  Allocates and loads the sprite.
    *  Part of this process will attempt to load a texture file.
    *  If this fails this function will return false and the memory
-   *  allocated, freed.
+   *  allocated, freed. A component that already has a sprite reuses it
+   *  rather than allocating another. If the texture was packed into the
+   *  sprite atlas the sprite uses its region of the atlas instead.
+   *  Otherwise, when a texture cache is given the pre-decoded copy of the
+   *  texture is loaded, falling back to the original file.
    *  @param [in] renderer The renderer used to perform the allocations
    *  @param [in] texture_file_name The file path to the the texture to load
+   *  @param [in] texture_cache The cache of decoded textures (optional)
+   *  @param [in] atlas The sprite atlas (optional)
    *  @return true if the sprite was successfully loaded
    */
-  bool
-  loadSprite(ASGE::Renderer* renderer, const std::string& texture_file_name);
+  bool loadSprite(ASGE::Renderer* renderer,
+                  const std::string& texture_file_name,
+                  TextureCache* texture_cache = nullptr,
+                  const SpriteAtlas* atlas = nullptr);
 
   /**
    *  Returns a pointer to the sprite residing in this component.
@@ -51,6 +63,9 @@ class SpriteComponent
   rect getBoundingBox() const;
 
  private:
+  bool loadFromAtlas(const std::string& texture_file_name,
+                     const SpriteAtlas* atlas);
+  void useWholeTexture();
   void free();
   ASGE::Sprite* sprite = nullptr;
 };
\ No newline at end of file
@@ -0,0 +1,235 @@
+#include "EnvironmentBatch.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Utility/Hash.h"
+
+// environments stepped per chunk when shared between threads
+const size_t ENV_CHUNK = 64;
+
+/**
+ *   @brief   Starts every environment from the beginning of a wave.
+ *   @details All of the batch's memory is allocated here, so stepping
+ *            never allocates.
+ *   @return  void
+ */
+void EnvironmentBatch::reset(const batch_settings& settings,
+                             const sim_layout& new_layout,
+                             const sim_state& new_start)
+{
+  setup = settings;
+  layout = new_layout;
+  start = new_start;
+  grid_columns =
+    static_cast<size_t>(std::ceil(layout.width / OBSERVATION_CELL_SIZE));
+  grid_rows =
+    static_cast<size_t>(std::ceil(layout.height / OBSERVATION_CELL_SIZE));
+
+  states.resize(setup.environments);
+  episodes.assign(setup.environments, 0);
+  for (size_t i = 0; i < states.size(); i++)
+  {
+    restart(i);
+  }
+}
+
+/**
+ *   @brief   Plays one frame in every environment.
+ *   @details An environment whose episode ends in the step is started
+ *            again straight away, so its observation is the first frame
+ *            of its next episode, while its reward and outcome are from
+ *            the step that ended the last one.
+ *   @return  void
+ */
+void EnvironmentBatch::step(const uint8_t* actions,
+                            float* observations,
+                            float* rewards,
+                            uint8_t* outcomes,
+                            WorkerPool* workers)
+{
+  size_t observation_size = observationSize();
+  auto job = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++)
+    {
+      sim_state& state = states[i];
+      int32_t score = state.score;
+      simulate(layout, state, actions[i], setup.step_time);
+      rewards[i] = static_cast<float>(state.score - score);
+
+      outcomes[i] = ENV_RUNNING;
+      if (state.game_over || state.wave_cleared)
+      {
+        outcomes[i] = state.game_over ? ENV_LOST : ENV_CLEARED;
+        restart(i);
+      }
+      observe(state, observations + i * observation_size);
+    }
+  };
+
+  if (workers)
+  {
+    workers->run(states.size(), ENV_CHUNK, job);
+  }
+  else
+  {
+    job(0, states.size());
+  }
+}
+
+void EnvironmentBatch::observe(float* observations, WorkerPool* workers) const
+{
+  size_t observation_size = observationSize();
+  auto job = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++)
+    {
+      observe(states[i], observations + i * observation_size);
+    }
+  };
+
+  if (workers)
+  {
+    workers->run(states.size(), ENV_CHUNK, job);
+  }
+  else
+  {
+    job(0, states.size());
+  }
+}
+
+/**
+ *   @brief   Works out how many floats an observation takes.
+ *   @details Positions are the player's x and y, then an x, y and alive
+ *            flag for each ship, player shot and enemy shot in turn. A
+ *            grid is one layer of cells per kind of object.
+ *   @return  The observation size.
+ */
+size_t EnvironmentBatch::observationSize() const
+{
+  if (setup.observation == Observation::GRID)
+  {
+    return OBSERVATION_CHANNELS * grid_columns * grid_rows;
+  }
+  return 2 + 3 * (static_cast<size_t>(layout.ship_count) + 2 * NUM_OF_SHOTS);
+}
+
+size_t EnvironmentBatch::size() const
+{
+  return states.size();
+}
+
+/**
+ *   @brief   Starts an environment's next episode.
+ *   @return  void
+ */
+void EnvironmentBatch::restart(size_t index)
+{
+  const uint64_t key[3] = { setup.seed, index, episodes[index]++ };
+  states[index] = start;
+  seedSimulation(layout, states[index], hashBytes(key, sizeof(key)));
+}
+
+void EnvironmentBatch::observe(const sim_state& state, float* observation) const
+{
+  if (setup.observation == Observation::GRID)
+  {
+    observeGrid(state, observation);
+  }
+  else
+  {
+    observePositions(state, observation);
+  }
+}
+
+/**
+ *   @brief   Writes where everything is.
+ *   @details Positions are divided by the size of the play area, so
+ *            they run from 0 to 1 whatever the resolution.
+ *   @return  void
+ */
+void EnvironmentBatch::observePositions(const sim_state& state,
+                                        float* observation) const
+{
+  float x_scale = 1 / layout.width;
+  float y_scale = 1 / layout.height;
+  auto put = [&](float x, float y, bool alive) {
+    *observation++ = x * x_scale;
+    *observation++ = y * y_scale;
+    *observation++ = alive ? 1.0f : 0.0f;
+  };
+
+  *observation++ = state.player_x * x_scale;
+  *observation++ = state.player_y * y_scale;
+  for (int i = 0; i < layout.ship_count; i++)
+  {
+    put(state.formation.origin_x + layout.slot_xs[i],
+        state.formation.origin_y + layout.slot_ys[i],
+        state.ships[i]);
+  }
+  for (int i = 0; i < NUM_OF_SHOTS; i++)
+  {
+    put(state.player_shot_xs[i],
+        state.player_shot_ys[i],
+        state.player_shots[i]);
+  }
+  for (int i = 0; i < NUM_OF_SHOTS; i++)
+  {
+    put(state.enemy_shot_xs[i], state.enemy_shot_ys[i], state.enemy_shots[i]);
+  }
+}
+
+/**
+ *   @brief   Writes an occupancy grid of the play area.
+ *   @details Each object adds one to the cell its centre is in, on the
+ *            layer for its kind. Objects off the edge count towards the
+ *            nearest cell.
+ *   @return  void
+ */
+void EnvironmentBatch::observeGrid(const sim_state& state,
+                                   float* observation) const
+{
+  size_t cells = grid_columns * grid_rows;
+  std::fill_n(observation, OBSERVATION_CHANNELS * cells, 0.0f);
+  auto last_column = static_cast<float>(grid_columns - 1);
+  auto last_row = static_cast<float>(grid_rows - 1);
+  auto mark = [&](size_t channel, float x, float y) {
+    auto column = static_cast<size_t>(
+      std::clamp(x / OBSERVATION_CELL_SIZE, 0.0f, last_column));
+    auto row = static_cast<size_t>(
+      std::clamp(y / OBSERVATION_CELL_SIZE, 0.0f, last_row));
+    observation[channel * cells + row * grid_columns + column] += 1;
+  };
+
+  for (int i = 0; i < layout.ship_count; i++)
+  {
+    if (state.ships[i])
+    {
+      mark(0,
+           state.formation.origin_x + layout.slot_xs[i] + layout.ship_width / 2,
+           state.formation.origin_y + layout.slot_ys[i] +
+             layout.ship_height / 2);
+    }
+  }
+
+  mark(1,
+       state.player_x + layout.player_width / 2,
+       state.player_y + layout.player_height / 2);
+
+  float middle_x = layout.shot_width / 2;
+  float middle_y = layout.shot_height / 2;
+  for (int i = 0; i < NUM_OF_SHOTS; i++)
+  {
+    if (state.player_shots[i])
+    {
+      mark(2,
+           state.player_shot_xs[i] + middle_x,
+           state.player_shot_ys[i] + middle_y);
+    }
+    if (state.enemy_shots[i])
+    {
+      mark(3,
+           state.enemy_shot_xs[i] + middle_x,
+           state.enemy_shot_ys[i] + middle_y);
+    }
+  }
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Simulation.h"
+#include "Utility/WorkerPool.h"
+
+/**
+ *  What an environment's observation holds.
+ */
+enum class Observation : uint8_t
+{
+  POSITIONS = 0, /**< Where each object is, and whether it is alive. */
+  GRID = 1       /**< How many objects of each kind are in each cell. */
+};
+
+// how an environment's step ended
+const uint8_t ENV_RUNNING = 0;
+const uint8_t ENV_LOST = 1;
+const uint8_t ENV_CLEARED = 2;
+
+// the size of a cell in an occupancy grid observation, in pixels
+const float OBSERVATION_CELL_SIZE = 40;
+// kinds of object in a grid: ships, the player, player and enemy shots
+const size_t OBSERVATION_CHANNELS = 4;
+
+/**
+ *  How an EnvironmentBatch is set up.
+ */
+struct batch_settings
+{
+  size_t environments = 1;
+  uint64_t seed = 0;           /**< Every episode's seed comes from this. */
+  float step_time = 1.0f / 60; /**< Seconds each step lasts. */
+  Observation observation = Observation::POSITIONS;
+};
+
+/**
+ *  Many copies of a wave, played in lockstep for training agents.
+ *  Each step takes one action per environment and writes every
+ *  environment's observation, reward and outcome straight into buffers
+ *  owned by the caller, each environment's entries next to each other.
+ *  Environments are independent headless simulations, so they are
+ *  shared out across a WorkerPool in chunks. An environment whose
+ *  episode ends starts again from the wave's first frame, seeded by the
+ *  batch's seed, its index and its episode count, so a batch always
+ *  plays out the same way however many threads step it.
+ */
+class EnvironmentBatch
+{
+ public:
+  EnvironmentBatch() = default;
+  ~EnvironmentBatch() = default;
+
+  /**
+   *  Starts every environment from the beginning of a wave.
+   *  @param [in] settings How the batch is set up
+   *  @param [in] layout The wave to play
+   *  @param [in] start The state every episode starts from
+   */
+  void reset(const batch_settings& settings,
+             const sim_layout& layout,
+             const sim_state& start);
+
+  /**
+   *  Plays one frame in every environment.
+   *  @param [in] actions size() actions, each made of ACTION_ bits
+   *  @param [out] observations size() * observationSize() floats
+   *  @param [out] rewards size() floats, the score gained in the step
+   *  @param [out] outcomes size() ENV_ values, for how each step ended
+   *  @param [in] workers Threads to share the environments with
+   *                      (optional)
+   */
+  void step(const uint8_t* actions,
+            float* observations,
+            float* rewards,
+            uint8_t* outcomes,
+            WorkerPool* workers = nullptr);
+
+  /**
+   *  Writes every environment's current observation.
+   *  @param [out] observations size() * observationSize() floats
+   *  @param [in] workers Threads to share the environments with
+   *                      (optional)
+   */
+  void observe(float* observations, WorkerPool* workers = nullptr) const;
+
+  /**
+   *  The number of floats in one environment's observation.
+   *  @return the observation size
+   */
+  size_t observationSize() const;
+
+  size_t size() const;
+
+ private:
+  void restart(size_t index);
+  void observe(const sim_state& state, float* observation) const;
+  void observePositions(const sim_state& state, float* observation) const;
+  void observeGrid(const sim_state& state, float* observation) const;
+
+  batch_settings setup;
+  sim_layout layout;
+  sim_state start;
+  std::vector<sim_state> states;
+  std::vector<uint32_t> episodes;
+  size_t grid_columns = 0;
+  size_t grid_rows = 0;
+};
@@ -1,5 +1,9 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <iostream>
 #include <string>
+#include <thread>
 
 #include <Engine/DebugPrinter.h>
 #include <Engine/Input.h>
@@ -26,121 +30,535 @@ SpaceInvadersGame::SpaceInvadersGame()
  */
 SpaceInvadersGame::~SpaceInvadersGame()
 {
+  AllocationTracker::writeReport("allocations");
+
   this->inputs->unregisterCallback(static_cast<unsigned int>(key_callback_id));
   this->inputs->unregisterCallback(
     static_cast<unsigned int>(mouse_callback_id));
 }
 
-bool SpaceInvadersGame::setupObjects()
+/**
+ *   @brief   Sets the game up to soak test endless mode.
+ *   @details Endless mode starts as soon as loading is done, without
+ *            waiting on the menu, and every wave is cleared the frame
+ *            after it spawns.
+ *   @return  void
+ */
+void SpaceInvadersGame::soak(double minutes)
 {
-  // Player Setup
-  float player_x = static_cast<float>(game_width) / 2 - 50;
-  float player_y = static_cast<float>(game_height) - 100;
-  if (!controller.setupObject(&player,
-                              renderer.get(),
-                              "images/playerShip1_orange.png",
-                              player_x,
-                              player_y,
-                              0,
-                              0,
-                              200.0f,
-                              99,
-                              75,
-                              true))
-  {
-    std::cout << "Player NOT setup correctly" << std::endl;
-    return false;
-  }
-
-  // Ship Setup
-  for (int i = 0; i < NUM_OF_SHIPS; i++)
-  {
-    std::string file;
-    if (i < COLUMNS)
-    {
-      file = "images/enemyBlack1.png";
-    }
-    else if (i < COLUMNS * 2)
-    {
-      file = "images/enemyBlue1.png";
-    }
-    else if (i < COLUMNS * 3)
-    {
-      file = "images/enemyGreen1.png";
-    }
-    else if (i < COLUMNS * 4)
-    {
-      file = "images/enemyRed1.png";
-    }
-    else
-    {
-      file = "images/enemyBlack1.png";
-    }
+  soaking = true;
+  soak_minutes = minutes;
+  game_mode = ENDLESS_MODE;
+}
 
-    if (!controller.setupObject(&ships[i],
+/**
+ *   @brief   Queues the game's objects for loading.
+ *   @details Nothing is loaded here. Each object becomes a job on the
+ *            asset loader, which streams them in over the first few
+ *            frames so that the menu can be shown straight away.
+ *            The player is queued first as it is needed by every mode.
+ *   @return  void
+ */
+void SpaceInvadersGame::setupObjects()
+{
+  // Player Setup
+  asset_loader.queue("images/playerShip1_orange.png", [this]() {
+    float player_x = static_cast<float>(game_width) / 2 - 50;
+    float player_y = static_cast<float>(game_height) - 100;
+    if (!controller.setupObject(&player,
                                 renderer.get(),
-                                file,
-                                static_cast<float>(i % COLUMNS) * 60 + 20,
-                                static_cast<float>(i % ROWS) * 70 + 20,
-                                1,
+                                "images/playerShip1_orange.png",
+                                player_x,
+                                player_y,
+                                0,
                                 0,
-                                50,
-                                50,
-                                50,
+                                PLAYER_SPEED,
+                                PLAYER_WIDTH,
+                                PLAYER_HEIGHT,
                                 true))
     {
-      std::cout << "Ship " << i << " NOT setup correctly" << std::endl;
+      std::cout << "Player NOT setup correctly" << std::endl;
       return false;
     }
+    player_mask = objectMask(&player, "images/playerShip1_orange.png");
+    return true;
+  });
+
+  // Ship Setup
+  const wave_definition* wave = waves.wave(0);
+  ship_count = std::min(static_cast<int>(wave->ships.size()), MAX_SHIPS);
+  formation.reset(ship_count, waveSpeed(*wave), wave->ship_width);
+  for (int i = 0; i < ship_count; i++)
+  {
+    const std::string& file = wave->textures[wave->ships[i].texture];
+    asset_loader.queue(file, [this, i, wave]() { return setupShip(i, *wave); });
   }
 
   // Setup Player Shots
   for (int i = 0; i < NUM_OF_SHOTS; i++)
   {
-    if (!controller.setupObject(&player_shots[i],
+    asset_loader.queue("images/laserBlue03.png", [this, i]() {
+      if (!controller.setupObject(&player_shots[i],
+                                  renderer.get(),
+                                  "images/laserBlue03.png",
+                                  0,
+                                  0,
+                                  0,
+                                  -1,
+                                  SHOT_SPEED,
+                                  SHOT_WIDTH,
+                                  SHOT_HEIGHT,
+                                  false))
+      {
+        std::cout << "Player Shot " << i << " NOT setup correctly"
+                  << std::endl;
+        return false;
+      }
+      player_shot_mask = objectMask(&player_shots[i], "images/laserBlue03.png");
+      return true;
+    });
+  }
+
+  // Setup Enemy Shots
+  for (int i = 0; i < NUM_OF_SHOTS; i++)
+  {
+    asset_loader.queue("images/laserRed03.png", [this, i]() {
+      if (!controller.setupObject(&enemy_shots[i],
+                                  renderer.get(),
+                                  "images/laserRed03.png",
+                                  0,
+                                  0,
+                                  0,
+                                  1,
+                                  SHOT_SPEED,
+                                  SHOT_WIDTH,
+                                  SHOT_HEIGHT,
+                                  false))
+      {
+        std::cout << "Enemy Shot " << i << " NOT setup correctly" << std::endl;
+        return false;
+      }
+      enemy_shot_mask = objectMask(&enemy_shots[i], "images/laserRed03.png");
+      return true;
+    });
+  }
+
+  // Setup Bullet Hell Bullets, all drawn with a single sprite
+  asset_loader.queue("images/laserRed10.png", [this]() {
+    if (!controller.setupObject(&bullet,
+                                renderer.get(),
+                                "images/laserRed10.png",
+                                0,
+                                0,
+                                0,
+                                0,
+                                0,
+                                BULLET_SIZE,
+                                BULLET_SIZE,
+                                false))
+    {
+      std::cout << "Bullet NOT setup correctly" << std::endl;
+      return false;
+    }
+    bullet_mask = objectMask(&bullet, "images/laserRed10.png");
+    return true;
+  });
+
+  // Setup Particles, all drawn with a single sprite
+  asset_loader.queue("images/particleWhite.png", [this]() {
+    if (!controller.setupObject(&particle,
                                 renderer.get(),
-                                "images/laserBlue03.png",
+                                "images/particleWhite.png",
+                                0,
                                 0,
                                 0,
                                 0,
-                                -1,
-                                200,
-                                10,
-                                20,
+                                0,
+                                PARTICLE_SIZE,
+                                PARTICLE_SIZE,
                                 false))
     {
-      std::cout << "Player Shot " << i << " NOT setup correctly" << std::endl;
+      std::cout << "Particle NOT setup correctly" << std::endl;
       return false;
     }
-  }
+    return true;
+  });
 
-  // Setup Enemy Shots
-  for (int i = 0; i < NUM_OF_SHOTS; i++)
-  {
-    if (!controller.setupObject(&enemy_shots[i],
+  // Setup Boids, all drawn with a single sprite
+  asset_loader.queue("images/enemyBlack1.png", [this]() {
+    if (!controller.setupObject(&boid,
                                 renderer.get(),
-                                "images/laserRed03.png",
+                                "images/enemyBlack1.png",
+                                0,
                                 0,
                                 0,
                                 0,
-                                1,
-                                200,
-                                10,
-                                20,
+                                0,
+                                BOID_SIZE,
+                                BOID_SIZE,
                                 false))
     {
-      std::cout << "Enemy Shot " << i << " NOT setup correctly" << std::endl;
+      std::cout << "Boid NOT setup correctly" << std::endl;
+      return false;
+    }
+    boid_mask = objectMask(&boid, "images/enemyBlack1.png");
+    return true;
+  });
+
+  asset_loader.start();
+}
+
+/**
+ *   @brief   Places a ship from a wave's prefab table.
+ *   @details Also remembers which row of the layout the ship is in, which
+ *            the curved movement modes use, and gives the ship its slot
+ *            in the formation. Ships take their components from the
+ *            ship pool in slot order, so each gets back the component it
+ *            had last wave. A slot that already shows the right texture
+ *            keeps it, so spawning a wave only loads sprites for slots
+ *            whose texture changes.
+ *   @return  False if the ship's sprite could not be loaded.
+ */
+bool SpaceInvadersGame::setupShip(int index, const wave_definition& wave)
+{
+  const ship_prefab& ship = wave.ships[static_cast<size_t>(index)];
+  const std::string& file = wave.textures[ship.texture];
+  float speed = waveSpeed(wave);
+  ship_rows[index] = ship.row;
+  formation.slot(index, ship.x, ship.y);
+  ship_masks[index] = masks.find(file, wave.ship_width, wave.ship_height);
+
+  if (ship_textures[index] && *ship_textures[index] == file)
+  {
+    ships[index].useSpriteComponent(ship_components.acquire(),
+                                    &ship_components);
+    controller.resetObject(&ships[index],
+                           ship.x,
+                           ship.y,
+                           1,
+                           0,
+                           speed,
+                           wave.ship_width,
+                           wave.ship_height,
+                           true);
+    return true;
+  }
+
+  ship_textures[index] = nullptr;
+  if (!controller.setupObject(&ships[index],
+                              renderer.get(),
+                              file,
+                              ship.x,
+                              ship.y,
+                              1,
+                              0,
+                              speed,
+                              wave.ship_width,
+                              wave.ship_height,
+                              true,
+                              &ship_components))
+  {
+    std::cout << "Ship " << index << " NOT setup correctly" << std::endl;
+    return false;
+  }
+  ship_textures[index] = &file;
+  return true;
+}
+
+/**
+ *   @brief   Finds the collision mask for an object's sprite.
+ *   @details The mask is scaled to the size the sprite is drawn at.
+ *   @return  The mask, or nullptr if there is none.
+ */
+const CollisionMask*
+SpaceInvadersGame::objectMask(GameObject* object, const std::string& file)
+{
+  const ASGE::Sprite* sprite = object->spriteComponent()->getSprite();
+  return masks.find(file, sprite->width(), sprite->height());
+}
+
+/**
+ *   @brief   Works out how fast a wave's ships move.
+ *   @details Every loop of endless mode makes the waves a little faster.
+ *   @return  The wave's speed.
+ */
+float SpaceInvadersGame::waveSpeed(const wave_definition& wave) const
+{
+  int speedups = std::min(endless_loops, ENDLESS_MAX_SPEEDUPS);
+  return wave.speed * (1 + ENDLESS_SPEEDUP * static_cast<float>(speedups));
+}
+
+/**
+ *   @brief   Checks whether the ships move as one block.
+ *   @details The other modes move each ship along its own path.
+ *   @return  True if the ships' positions come from the formation.
+ */
+bool SpaceInvadersGame::formationMode() const
+{
+  return game_mode == 0 || game_mode == ENDLESS_MODE ||
+         game_mode == BULLET_HELL_MODE;
+}
+
+/**
+ *   @brief   Checks whether the mode can be rewound.
+ *   @details Bullet hell has up to MAX_BULLETS in flight and swarm moves
+ *            every boid every frame, so a frame of either is too large
+ *            to keep ten seconds of. Rewinding is turned off in both
+ *            rather than rewinding without them, and the HUD says so.
+ *   @return  True if R rewinds the game.
+ */
+bool SpaceInvadersGame::rewindMode() const
+{
+  return game_mode != BULLET_HELL_MODE && game_mode != FLOCK_MODE;
+}
+
+/**
+ *   @brief   Checks whether the bot can play the mode.
+ *   @details The bot looks ahead with the headless simulation, which
+ *            only has the formation, the shots and the player. Paths,
+ *            dives, bullets and boids are not part of it, so the bot
+ *            would be choosing from futures that never happen.
+ *   @return  True if B hands the game to the bot.
+ */
+bool SpaceInvadersGame::botMode() const
+{
+  return formationMode() && game_mode != ENDLESS_MODE &&
+         game_mode != BULLET_HELL_MODE;
+}
+
+/**
+ *   @brief   Gets a ship's bounding box.
+ *   @details In formation mode the ship's sprite is only moved when it
+ *            is drawn, so its position is taken from the formation plus
+ *            any dive it is part way through.
+ *   @return  The ship's bounding box.
+ */
+rect SpaceInvadersGame::shipBounds(int index)
+{
+  rect bounds = ships[index].spriteComponent()->getBoundingBox();
+  if (formationMode())
+  {
+    bounds.x = formation.x(index) + dives.x(index);
+    bounds.y = formation.y(index) + dives.y(index);
+  }
+  return bounds;
+}
+
+/**
+ *   @brief   Works out which wave follows the current one.
+ *   @details Endless mode goes back to the first wave after the last.
+ *   @return  The next wave's index, which may be past the last wave.
+ */
+size_t SpaceInvadersGame::nextWaveIndex() const
+{
+  size_t next = current_wave + 1;
+  return game_mode == ENDLESS_MODE && next >= waves.count() ? 0 : next;
+}
+
+/**
+ *   @brief   Loads the next wave's textures while this one is played.
+ *   @details Once the next wave has been parsed, each of its images is
+ *            queued on the wave loader, which loads them into a spare
+ *            sprite a few at a time. ASGE keeps every texture it loads,
+ *            so when the wave starts its ships find their textures
+ *            already on the GPU. If the wave starts before they are all
+ *            in, the rest are loaded with its ships as before.
+ *   @return  void
+ */
+void SpaceInvadersGame::streamNextWave()
+{
+  if (!wave_loader.finished())
+  {
+    wave_loader.process(WAVE_LOAD_BUDGET);
+    return;
+  }
+
+  size_t next = nextWaveIndex();
+  if (next == streamed_wave || waves.loading(next))
+  {
+    return;
+  }
+
+  const wave_definition* wave = waves.wave(next);
+  if (!wave)
+  {
+    return;
+  }
+
+  streamed_wave = next;
+  for (const std::string& file : wave->textures)
+  {
+    const std::string* texture = &file;
+    wave_loader.queue(file, [this, texture]() {
+      wave_textures.loadSprite(
+        renderer.get(), *texture, &texture_cache, &sprite_atlas);
+      return true;
+    });
+  }
+  wave_loader.start();
+}
+
+/**
+ *   @brief   Replaces a cleared wave with the next one.
+ *   @details Called once WAVE_DELAY has passed since the last ship of
+ *            the wave was destroyed. The next wave has normally been
+ *            loaded in the background long before it is needed. If it
+ *            is still loading, nothing happens and this is tried again
+ *            on the next frame. Ships left over from a larger wave are
+ *            hidden. Endless mode goes back to the first wave after the
+ *            last, reusing the same ship slots, sprites and parsed waves
+ *            so memory stays flat.
+ *   @return  False once there are no waves left to play.
+ */
+bool SpaceInvadersGame::nextWave()
+{
+  size_t next = nextWaveIndex();
+  if (next == 0)
+  {
+    endless_loops++;
+  }
+
+  if (waves.loading(next))
+  {
+    return true;
+  }
+
+  const wave_definition* wave = waves.wave(next);
+  if (!wave)
+  {
+    return false;
+  }
+
+  current_wave = next;
+  gameplay_frames = 0;
+  wave_due = false;
+  if (!placeWave(*wave))
+  {
+    signalExit();
+    return false;
+  }
+
+  soak_monitor.spawned(ship_count);
+  for (int i = 0; i < NUM_OF_SHOTS; i++)
+  {
+    enemy_shots[i].visible(false);
+  }
+  bullets.clear();
+  dives.clear();
+  scripts.clear();
+  startScripts();
+  return true;
+}
+
+/**
+ *   @brief   Puts a wave's ships in their slots.
+ *   @details The last wave's ship components are all released at once,
+ *            and the new wave's taken again from the front of the pool.
+ *            Ships left over from a larger wave are hidden.
+ *   @return  False if a ship's sprite could not be loaded.
+ */
+bool SpaceInvadersGame::placeWave(const wave_definition& wave)
+{
+  for (auto& ship : ships)
+  {
+    ship.dropSpriteComponent();
+  }
+  ship_components.releaseAll();
+
+  int count = std::min(static_cast<int>(wave.ships.size()), MAX_SHIPS);
+  formation.reset(count, waveSpeed(wave), wave.ship_width);
+  for (int i = 0; i < count; i++)
+  {
+    if (!setupShip(i, wave))
+    {
+      // only the ships placed so far have components
+      ship_count = i;
       return false;
     }
   }
+
+  for (int i = count; i < ship_count; i++)
+  {
+    ships[i].visible(false);
+  }
+  ship_count = count;
+  return true;
+}
+
+/**
+ *   @brief   Lays out all of the game's text.
+ *   @details The menu and end screen text never changes, so it is all
+ *            built here once. The menu has both a selected and an
+ *            unselected line for each mode so switching modes only
+ *            changes which one is drawn.
+ *   @return  void
+ */
+void SpaceInvadersGame::setupText()
+{
+  menu_text =
+    text.add("Please choose a mode, press ENTER to continue", 70, 260);
+  loading_text = text.add("Loading... 0%", 250, 260);
+
+  const char* mode_names[NUM_OF_MODES] = {
+    "Normal",  "Gravity",     "Quadratic Curve", "Sine Curve",
+    "Endless", "Bullet Hell", "Swarm"
+  };
+  const int mode_x[NUM_OF_MODES] = { 260, 255, 210, 240, 255, 235, 262 };
+  for (int i = 0; i < NUM_OF_MODES; i++)
+  {
+    int y = 350 + i * 50;
+    std::string name = mode_names[i];
+    mode_text[i][0] = text.add("   " + name, mode_x[i], y);
+    mode_text[i][1] = text.add(">> " + name, mode_x[i], y);
+  }
+
+  score_text = text.add("Score: 0", 525, 50, 1, ASGE::COLOURS::WHITE);
+  no_rewind_text = text.add("No rewind", 20, 50, 1, ASGE::COLOURS::WHITE);
+
+  won_text[0] = text.add("Congratulations!", 230, 450);
+  won_text[1] =
+    text.add("You have saved the human race from destruction!", 70, 470);
+
+  lost_text[0] = text.add("You've Lost...", 235, 440);
+  lost_text[1] =
+    text.add("You have single handily managed to cause the", 80, 460);
+  lost_text[2] =
+    text.add("desolation of human kind due to your incompetence", 50, 480);
+}
+
+/**
+ *   @brief   Streams in any assets still waiting to be loaded.
+ *   @details Called once per frame from update until every asset has
+ *            been loaded. Loading is limited to a small slice of each
+ *            frame so the menu stays responsive while it happens.
+ *   @return  False if an asset failed to load.
+ */
+bool SpaceInvadersGame::loadAssets()
+{
+  if (!asset_loader.process(ASSET_LOAD_BUDGET))
+  {
+    return false;
+  }
+
+  if (asset_loader.finished())
+  {
+    // misses are textures decoded this run (a cold start), hits are
+    // textures loaded pre-decoded from an earlier run (a warm start)
+    ASGE::DebugPrinter{} << "Assets loaded in "
+                         << asset_loader.uploadTime().count() / 1000.0
+                         << "ms (texture cache hits: " << texture_cache.hits()
+                         << ", misses: " << texture_cache.misses() << ")"
+                         << std::endl;
+  }
   return true;
 }
 
 /**
  *   @brief   Initialises the game.
  *   @details The game window is created and all assets required to
- *            run the game are loaded. The keyHandler and clickHandler
- *            callback should also be set in the initialise function.
+ *            run the game are queued for loading. The keyHandler and
+ *            clickHandler callback should also be set in the initialise
+ *            function.
  *   @return  True if the game initialised correctly.
  */
 bool SpaceInvadersGame::init()
@@ -149,12 +567,50 @@ bool SpaceInvadersGame::init()
   setupResolution();
   controller.gameHeight(static_cast<float>(game_height));
   controller.gameWidth(static_cast<float>(game_width));
+  controller.bakeTrajectories(MAX_SHIPS);
+  formation.bounds(static_cast<float>(game_width));
   if (!initAPI())
   {
     return false;
   }
 
   renderer->setClearColour(ASGE::COLOURS::BLACK);
+  renderer->setSpriteMode(ASGE::SpriteSortMode::DEFERRED);
+
+  frame_arena.reserve(FRAME_ARENA_SIZE);
+  render_queue.viewport(static_cast<float>(game_width),
+                        static_cast<float>(game_height));
+  render_queue.reserve(NUM_OF_SPRITES);
+  bullets.reserve(MAX_BULLETS);
+  particles.reserve(MAX_PARTICLES);
+  dives.reserve(MAX_SHIPS);
+  setupDivePaths();
+  scripts.reserve(MAX_SHIPS);
+  setupScripts();
+  events.reserve(MAX_EVENTS);
+  saved_state = std::make_unique<game_state>();
+  rewind_history.reserve(REWIND_BYTES,
+                         REWIND_SECONDS,
+                         REWIND_FRAMES,
+                         sizeof(StateHeader) + sizeof(game_state),
+                         REWIND_KEYFRAME_INTERVAL);
+  rewind_frame.reserve(sizeof(StateHeader) + sizeof(game_state));
+  bullets.bounds(static_cast<float>(game_width),
+                 static_cast<float>(game_height),
+                 BULLET_SIZE);
+  flock.reserve(FLOCK_SIZE);
+  flock.bounds(static_cast<float>(game_width),
+               static_cast<float>(game_height),
+               BOID_SIZE);
+  flock_rules swarm;
+  swarm.chase = 60;
+  swarm.max_speed = 140;
+  flock.rules(swarm);
+  workers.start(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+  rollout_settings search;
+  search.rollouts =
+    BOT_ROLLOUTS_PER_THREAD * static_cast<int>(workers.threads());
+  bot.settings(search);
 
   toggleFPS();
 
@@ -167,7 +623,33 @@ bool SpaceInvadersGame::init()
   mouse_callback_id = inputs->addCallbackFnc(
     ASGE::E_MOUSE_CLICK, &SpaceInvadersGame::clickHandler, this);
 
-  return setupObjects();
+  if (archive.open("game.pak"))
+  {
+    asset_loader.useArchive(&archive);
+    wave_loader.useArchive(&archive);
+    texture_cache.useArchive(&archive);
+  }
+
+  sprite_components.reserve(NUM_OF_SPRITES - MAX_SHIPS);
+  ship_components.reserve(MAX_SHIPS);
+  controller.componentPool(&sprite_components);
+  controller.textureCache(&texture_cache);
+
+  if (!waves.load(archive.isOpen() ? &archive : nullptr))
+  {
+    std::cout << "Waves NOT loaded correctly" << std::endl;
+    return false;
+  }
+
+  if (sprite_atlas.load(archive.isOpen() ? &archive : nullptr))
+  {
+    controller.spriteAtlas(&sprite_atlas);
+  }
+  masks.load(archive.isOpen() ? &archive : nullptr);
+
+  setupText();
+  setupObjects();
+  return true;
 }
 
 /**
@@ -201,24 +683,70 @@ void SpaceInvadersGame::setupResolution()
 void SpaceInvadersGame::keyHandler(const ASGE::SharedEventData data)
 {
   auto key = static_cast<const ASGE::KeyEvent*>(data.get());
+  frame_scheduler.wake();
 
   if (key->key == ASGE::KEYS::KEY_ESCAPE)
   {
     signalExit();
   }
 
-  else if (key->key == ASGE::KEYS::KEY_ENTER)
+  else if (key->key == ASGE::KEYS::KEY_ENTER && asset_loader.finished())
   {
+    if (in_menu)
+    {
+      startGameplay();
+    }
     in_menu = false;
   }
 
+  else if (!in_menu && !game_over && !game_won &&
+           key->key == ASGE::KEYS::KEY_S &&
+           key->action == ASGE::KEYS::KEY_PRESSED)
+  {
+    quickSave();
+  }
+
+  else if (asset_loader.finished() && key->key == ASGE::KEYS::KEY_L &&
+           key->action == ASGE::KEYS::KEY_PRESSED)
+  {
+    quickLoad();
+  }
+
+  else if (!in_menu && rewindMode() && key->key == ASGE::KEYS::KEY_R)
+  {
+    rewinding = key->action != ASGE::KEYS::KEY_RELEASED;
+    if (key->action == ASGE::KEYS::KEY_PRESSED)
+    {
+      rewind_backlog = 0;
+    }
+  }
+
+  else if (!in_menu && botMode() && key->key == ASGE::KEYS::KEY_B &&
+           key->action == ASGE::KEYS::KEY_PRESSED)
+  {
+    bot_playing = !bot_playing;
+    player.direction(0, 0);
+    if (!bot_playing)
+    {
+      ASGE::DebugPrinter{} << "Bot simulated " << bot.steps()
+                           << " frames at " << bot.stepsPerSecond()
+                           << " frames/s" << std::endl;
+    }
+  }
+
+  else if (!in_menu && key->key == ASGE::KEYS::KEY_F &&
+           key->action == ASGE::KEYS::KEY_PRESSED)
+  {
+    reportRenderStats();
+  }
+
   else if (key->key == ASGE::KEYS::KEY_UP &&
            key->action == ASGE::KEYS::KEY_PRESSED)
   {
     game_mode--;
     if (game_mode < 0)
     {
-      game_mode = 3;
+      game_mode = NUM_OF_MODES - 1;
     }
   }
 
@@ -226,7 +754,7 @@ void SpaceInvadersGame::keyHandler(const ASGE::SharedEventData data)
            key->action == ASGE::KEYS::KEY_PRESSED)
   {
     game_mode++;
-    if (game_mode > 3)
+    if (game_mode >= NUM_OF_MODES)
     {
       game_mode = 0;
     }
@@ -260,35 +788,92 @@ void SpaceInvadersGame::keyHandler(const ASGE::SharedEventData data)
            key->key == ASGE::KEYS::KEY_SPACE &&
            key->action == ASGE::KEYS::KEY_PRESSED)
   {
-    for (int i = 0; i < NUM_OF_SHOTS; i++)
+    firePlayerShot();
+  }
+}
+
+/**
+ *   @brief   Fires a shot from the player's ship, if one is free.
+ *   @return  void
+ */
+void SpaceInvadersGame::firePlayerShot()
+{
+  for (int i = 0; i < NUM_OF_SHOTS; i++)
+  {
+    if (!player_shots[i].visible())
     {
-      if (!player_shots[i].visible())
-      {
-        player_shots[i].visible(true);
-        player_shots[i].spriteComponent()->getSprite()->xPos(
-          player.spriteComponent()->getSprite()->xPos() +
-          (player.spriteComponent()->getSprite()->width() / 2));
-        player_shots[i].spriteComponent()->getSprite()->yPos(
-          player.spriteComponent()->getSprite()->yPos() - 10);
-        break;
-      }
+      player_shots[i].visible(true);
+      player_shots[i].spriteComponent()->getSprite()->xPos(
+        player.spriteComponent()->getSprite()->xPos() +
+        (player.spriteComponent()->getSprite()->width() / 2));
+      player_shots[i].spriteComponent()->getSprite()->yPos(
+        player.spriteComponent()->getSprite()->yPos() - 10);
+      break;
     }
   }
 }
 
 /**
- *   @brief   Processes any click inputs
- *   @details This function is added as a callback to handle the game's
- *            mouse button input. For this game, calls to this function
- *            are thread safe, so you may alter the game's state as you
- *            see fit.
- *   @param   data The event data relating to key input.
- *   @see     ClickEvent
+ *   @brief   Destroys the wave's ships on a soak run.
+ *   @details Ships are scored as if they had been shot but leave no
+ *            explosion, so the run measures spawning waves rather than
+ *            particles. The next wave is then placed the same frame.
  *   @return  void
  */
-void SpaceInvadersGame::clickHandler(const ASGE::SharedEventData data)
+void SpaceInvadersGame::clearSoakWave()
 {
-  auto click = static_cast<const ASGE::ClickEvent*>(data.get());
+  for (int i = 0; i < ship_count; i++)
+  {
+    if (ships[i].visible())
+    {
+      ships[i].visible(false);
+      score += 5;
+    }
+  }
+}
+
+/**
+ *   @brief   Records a soak run's frame.
+ *   @details The frame's work is timed from the end of the scheduler's
+ *            wait to the end of rendering, so it leaves out vsync. Once
+ *            a minute the spawn rate and the mean frame time, against
+ *            the first minute's, are written to the console.
+ *   @return  void
+ */
+void SpaceInvadersGame::reportSoak(double delta_time)
+{
+  std::chrono::duration<double, std::milli> work =
+    std::chrono::steady_clock::now() - frame_start;
+  if (soak_monitor.frame(delta_time, work.count()))
+  {
+    const soak_report& report = soak_monitor.report();
+    std::cout << "soak minute " << report.interval << ": "
+              << static_cast<int>(report.ships_per_minute)
+              << " ships/min, frame " << report.frame_ms << "ms (first "
+              << report.first_frame_ms << "ms, drift "
+              << report.frame_ms - report.first_frame_ms << "ms)"
+              << std::endl;
+  }
+
+  if (soak_minutes > 0 && soak_monitor.elapsed() >= soak_minutes * 60)
+  {
+    signalExit();
+  }
+}
+
+/**
+ *   @brief   Processes any click inputs
+ *   @details This function is added as a callback to handle the game's
+ *            mouse button input. For this game, calls to this function
+ *            are thread safe, so you may alter the game's state as you
+ *            see fit.
+ *   @param   data The event data relating to key input.
+ *   @see     ClickEvent
+ *   @return  void
+ */
+void SpaceInvadersGame::clickHandler(const ASGE::SharedEventData data)
+{
+  auto click = static_cast<const ASGE::ClickEvent*>(data.get());
 
   double x_pos = click->xpos;
   double y_pos = click->ypos;
@@ -299,48 +884,60 @@ void SpaceInvadersGame::clickHandler(const ASGE::SharedEventData data)
 
 void SpaceInvadersGame::updateGameStates()
 {
-  game_won = true;
-  for (int i = 0; i < NUM_OF_SHIPS; i++)
+  if (game_mode == FLOCK_MODE)
   {
-    if (ships[i].visible())
+    if (flock.size() == 0)
     {
-      game_won = false;
-      break;
+      game_won = true;
     }
-  }
 
-  for (int i = 0; i < NUM_OF_SHIPS; i++)
-  {
-    if (ships[i].spriteComponent()->getBoundingBox().isInside(
-          player.spriteComponent()->getBoundingBox()))
+    if (flock.hits(
+          player.spriteComponent()->getBoundingBox(), player_mask, boid_mask))
     {
       game_over = true;
     }
+    return;
   }
-}
 
-void SpaceInvadersGame::normalEnemyMovement(float prev_dir,
-                                            float enemy_direction,
-                                            double delta_time)
-{
-  if (prev_dir != enemy_direction)
+  bool wave_cleared = true;
+  for (int i = 0; i < ship_count; i++)
   {
-    for (int i = 0; i < NUM_OF_SHIPS; i++)
+    if (ships[i].visible())
     {
-      ships[i].spriteComponent()->getSprite()->yPos(
-        ships[i].spriteComponent()->getSprite()->yPos() + 10);
+      wave_cleared = false;
+      break;
     }
   }
 
-  for (int i = 0; i < NUM_OF_SHIPS; i++)
+  if (wave_cleared && soaking)
   {
-    controller.moveObject(&ships[i], delta_time);
+    wave_due = true;
+  }
+  else if (wave_cleared && !wave_due && !events.active(wave_timer))
+  {
+    scheduleNextWave(WAVE_DELAY);
+  }
+
+  if (wave_due && !nextWave())
+  {
+    game_won = true;
+  }
+
+  for (int i = 0; i < ship_count; i++)
+  {
+    if (CollisionMask::touching(shipBounds(i),
+                                ship_masks[i],
+                                player.spriteComponent()->getBoundingBox(),
+                                player_mask))
+    {
+      game_over = true;
+    }
   }
 }
 
 void SpaceInvadersGame::gravityEnemyMovement(double delta_time)
 {
-  for (int i = 0; i < NUM_OF_SHIPS; i++)
+  for (int i = 0; i < ship_count; i++)
   {
     controller.moveObject(&ships[i], delta_time);
     controller.applyGravity(&ships[i], delta_time);
@@ -349,20 +946,20 @@ void SpaceInvadersGame::gravityEnemyMovement(double delta_time)
 
 void SpaceInvadersGame::quadraticEnemyMovement(double delta_time)
 {
-  for (int i = 0; i < NUM_OF_SHIPS; i++)
+  for (int i = 0; i < ship_count; i++)
   {
     controller.moveObject(&ships[i], delta_time);
-    controller.applyQuadraticTrajectory(&ships[i], delta_time, i % ROWS);
   }
+  controller.applyQuadraticTrajectory(ships, ship_rows, ship_count);
 }
 
 void SpaceInvadersGame::sinEnemyMovement(double delta_time)
 {
-  for (int i = 0; i < NUM_OF_SHIPS; i++)
+  for (int i = 0; i < ship_count; i++)
   {
     controller.moveObject(&ships[i], delta_time);
-    controller.applySinTrajectory(&ships[i], delta_time, i % ROWS);
   }
+  controller.applySinTrajectory(ships, ship_rows, ship_count);
 }
 
 void SpaceInvadersGame::moveObjects(double delta_time)
@@ -370,32 +967,78 @@ void SpaceInvadersGame::moveObjects(double delta_time)
   controller.moveObject(&player, delta_time);
 
   // Move Enemies
+  if (formationMode())
+  {
+    formation.advance(delta_time);
+    dives.update(static_cast<float>(delta_time));
+  }
+  else if (game_mode == FLOCK_MODE)
+  {
+    rect target = player.spriteComponent()->getBoundingBox();
+    flock.update(static_cast<float>(delta_time),
+                 target.x + target.length / 2,
+                 target.y + target.height / 2,
+                 &workers);
+  }
+  else
+  {
+    moveShips(delta_time);
+  }
+
+  for (int i = 0; i < NUM_OF_SHOTS; i++)
+  {
+    if (player_shots[i].visible())
+    {
+      controller.moveObject(&player_shots[i], delta_time);
+    }
+  }
+
+  for (int i = 0; i < NUM_OF_SHOTS; i++)
+  {
+    if (enemy_shots[i].visible())
+    {
+      controller.moveObject(&enemy_shots[i], delta_time);
+    }
+  }
+}
+
+/**
+ *   @brief   Moves each ship along its own path.
+ *   @details Used by the modes where ships leave the formation. The
+ *            ships still turn around together at the edges.
+ *   @return  void
+ */
+void SpaceInvadersGame::moveShips(double delta_time)
+{
   float enemy_direction = ships[0].direction().x;
   float prev_dir = enemy_direction;
 
-  if (ships[COLUMNS - 1].spriteComponent()->getSprite()->xPos() + 40 >
-        static_cast<float>(game_width) - 20 &&
+  float left = static_cast<float>(game_width);
+  float right = 0;
+  for (int i = 0; i < ship_count; i++)
+  {
+    const ASGE::Sprite* sprite = ships[i].spriteComponent()->getSprite();
+    left = std::min(left, sprite->xPos());
+    right = std::max(right, sprite->xPos() + sprite->width());
+  }
+
+  if (right > static_cast<float>(game_width) - 20 &&
       prev_dir == enemy_direction)
   {
     enemy_direction = -1;
   }
-  else if (ships[0].spriteComponent()->getSprite()->xPos() < 20 &&
-           prev_dir == enemy_direction)
+  else if (left < 20 && prev_dir == enemy_direction)
   {
     enemy_direction = 1;
   }
 
-  for (int i = 0; i < NUM_OF_SHIPS; i++)
+  for (int i = 0; i < ship_count; i++)
   {
     ships[i].direction(enemy_direction, 0);
   }
 
   switch (game_mode)
   {
-    case 0:
-      normalEnemyMovement(prev_dir, enemy_direction, delta_time);
-      break;
-
     case 1:
       gravityEnemyMovement(delta_time);
       break;
@@ -408,22 +1051,6 @@ void SpaceInvadersGame::moveObjects(double delta_time)
       sinEnemyMovement(delta_time);
       break;
   }
-
-  for (int i = 0; i < NUM_OF_SHOTS; i++)
-  {
-    if (player_shots[i].visible())
-    {
-      controller.moveObject(&player_shots[i], delta_time);
-    }
-  }
-
-  for (int i = 0; i < NUM_OF_SHOTS; i++)
-  {
-    if (enemy_shots[i].visible())
-    {
-      controller.moveObject(&enemy_shots[i], delta_time);
-    }
-  }
 }
 
 void SpaceInvadersGame::shotCollision()
@@ -431,15 +1058,43 @@ void SpaceInvadersGame::shotCollision()
   // Player Shots
   for (int i = 0; i < NUM_OF_SHOTS; i++)
   {
-    for (int j = 0; j < NUM_OF_SHIPS; j++)
+    for (int j = 0; j < ship_count; j++)
     {
-      if (player_shots[i].spriteComponent()->getBoundingBox().isInside(
-            ships[j].spriteComponent()->getBoundingBox()) &&
-          player_shots[i].visible() && ships[j].visible())
+      if (player_shots[i].visible() && ships[j].visible() &&
+          CollisionMask::touching(
+            player_shots[i].spriteComponent()->getBoundingBox(),
+            player_shot_mask,
+            shipBounds(j),
+            ship_masks[j]))
       {
         ships[j].visible(false);
         player_shots[i].visible(false);
         score += 5;
+
+        rect ship = shipBounds(j);
+        particles.burst(ship.x + (ship.length - PARTICLE_SIZE) / 2,
+                        ship.y + (ship.height - PARTICLE_SIZE) / 2,
+                        EXPLOSION_PARTICLES,
+                        EXPLOSION_SPEED,
+                        EXPLOSION_LIFETIME,
+                        ASGE::COLOURS::DARKORANGE);
+      }
+    }
+
+    if (player_shots[i].visible() && game_mode == FLOCK_MODE)
+    {
+      rect shot = player_shots[i].spriteComponent()->getBoundingBox();
+      int killed = flock.destroy(shot, player_shot_mask, boid_mask);
+      if (killed > 0)
+      {
+        player_shots[i].visible(false);
+        score += killed;
+        particles.burst(shot.x,
+                        shot.y,
+                        EXPLOSION_PARTICLES,
+                        EXPLOSION_SPEED,
+                        EXPLOSION_LIFETIME,
+                        ASGE::COLOURS::DARKORANGE);
       }
     }
 
@@ -459,15 +1114,636 @@ void SpaceInvadersGame::shotCollision()
       enemy_shots[i].visible(false);
     }
 
-    if (enemy_shots[i].spriteComponent()->getBoundingBox().isInside(
-          player.spriteComponent()->getBoundingBox()) &&
-        enemy_shots[i].visible())
+    if (enemy_shots[i].visible() &&
+        CollisionMask::touching(
+          enemy_shots[i].spriteComponent()->getBoundingBox(),
+          enemy_shot_mask,
+          player.spriteComponent()->getBoundingBox(),
+          player_mask))
     {
       game_over = true;
     }
   }
 }
 
+/**
+ *   @brief   Fires the bullet hell mode's bullet patterns.
+ *   @details Every interval each ship fires a ring of bullets from its
+ *            centre. Alternate ships fire fixed radial rings and rings
+ *            that turn a little every time, which trace out spirals.
+ *   @return  void
+ */
+void SpaceInvadersGame::fireBullets(float delta_time)
+{
+  const float two_pi = 6.28318530718f;
+  bullet_timer += delta_time;
+  while (bullet_timer >= BULLET_INTERVAL)
+  {
+    bullet_timer -= BULLET_INTERVAL;
+    bullet_angle = std::fmod(bullet_angle + BULLET_SPIN, two_pi);
+
+    for (int i = 0; i < ship_count; i++)
+    {
+      if (!ships[i].visible())
+      {
+        continue;
+      }
+
+      rect ship = shipBounds(i);
+      float x = ship.x + (ship.length - BULLET_SIZE) / 2;
+      float y = ship.y + (ship.height - BULLET_SIZE) / 2;
+      float start_angle = i % 2 == 0 ? 0 : bullet_angle;
+      for (int j = 0; j < BULLET_RING; j++)
+      {
+        float angle = start_angle + two_pi * static_cast<float>(j) /
+                                      static_cast<float>(BULLET_RING);
+        bullets.spawn(x,
+                      y,
+                      std::cos(angle) * BULLET_SPEED,
+                      std::sin(angle) * BULLET_SPEED);
+      }
+    }
+  }
+}
+
+/**
+ *   @brief   Lays out the paths ships dive along in endless mode.
+ *   @details Each path is a list of offsets from the ship's slot, so it
+ *            starts and ends where the ship sits in the formation.
+ *   @return  void
+ */
+void SpaceInvadersGame::setupDivePaths()
+{
+  // a swoop down and round, back in from the other side
+  dives.addPath({ { 0, 0 },
+                  { 40, -30 },
+                  { 100, 60 },
+                  { 60, 240 },
+                  { -60, 320 },
+                  { -140, 200 },
+                  { -80, 60 },
+                  { 0, 0 } });
+
+  // a loop part way down
+  dives.addPath({ { 0, 0 },
+                  { 50, 80 },
+                  { 20, 220 },
+                  { -60, 200 },
+                  { -40, 120 },
+                  { 40, 160 },
+                  { 20, 60 },
+                  { 0, 0 } });
+
+  // a deep dive at the player
+  dives.addPath({ { 0, 0 },
+                  { 30, -20 },
+                  { 80, 120 },
+                  { 20, 480 },
+                  { -60, 560 },
+                  { -120, 360 },
+                  { -60, 100 },
+                  { 0, 0 } });
+}
+
+/**
+ *   @brief   Writes the scripts that drive ships in endless mode.
+ *   @details Each ship waits a while, dives out of the formation firing
+ *            as it goes, rejoins, and starts over. The long, random
+ *            first wait spreads the ships' attacks out.
+ *   @return  void
+ */
+void SpaceInvadersGame::setupScripts()
+{
+  dive_script.waitRandom(2, 40)
+    .dive()
+    .wait(0.4f)
+    .fire()
+    .wait(0.3f)
+    .fire()
+    .wait(0.3f)
+    .fire()
+    .rejoin()
+    .loop();
+
+  scripts.actions(
+    [this](int ship) { return ships[ship].visible(); },
+    [this](int ship) {
+      size_t path = static_cast<size_t>(std::rand()) % dives.paths();
+      if (!dives.start(ship, path, DIVE_SPEED, std::rand() % 2 == 0))
+      {
+        return 0.0f;
+      }
+      return dives.length(path) / DIVE_SPEED;
+    },
+    [this](int ship) {
+      for (int i = 0; i < NUM_OF_SHOTS; i++)
+      {
+        if (!enemy_shots[i].visible())
+        {
+          fireEnemyShot(i, ship);
+          return;
+        }
+      }
+    });
+}
+
+/**
+ *   @brief   Gives every ship in the wave its script.
+ *   @details Only endless mode is scripted.
+ *   @return  void
+ */
+void SpaceInvadersGame::startScripts()
+{
+  if (game_mode != ENDLESS_MODE)
+  {
+    return;
+  }
+
+  for (int i = 0; i < ship_count; i++)
+  {
+    scripts.start(dive_script, i);
+  }
+}
+
+/**
+ *   @brief   Starts everything that runs on a timer once play begins.
+ *   @return  void
+ */
+void SpaceInvadersGame::startGameplay()
+{
+  bot_playing = bot_playing && botMode();
+  rewind_history.clear();
+  rewind_clock = 0;
+  spawnFlock();
+  startScripts();
+  for (int i = 0; i < NUM_OF_SHOTS; i++)
+  {
+    scheduleEnemyShot(i);
+  }
+}
+
+/**
+ *   @brief   Replaces the wave with a swarm in the flocking mode.
+ *   @details The boids start scattered across the top of the screen,
+ *            heading down at the player, and steer from there. The
+ *            wave's ships are hidden, so none of them fire.
+ *   @return  void
+ */
+void SpaceInvadersGame::spawnFlock()
+{
+  if (game_mode != FLOCK_MODE)
+  {
+    return;
+  }
+
+  for (int i = 0; i < ship_count; i++)
+  {
+    ships[i].visible(false);
+  }
+
+  float width = static_cast<float>(game_width) - BOID_SIZE;
+  for (size_t i = 0; i < FLOCK_SIZE; i++)
+  {
+    float x = width * static_cast<float>(std::rand()) / RAND_MAX;
+    float y = FLOCK_SPAWN_HEIGHT * static_cast<float>(std::rand()) / RAND_MAX;
+    float drift = static_cast<float>(std::rand()) / RAND_MAX - 0.5f;
+    flock.spawn(x, y, drift * 100, 80);
+  }
+}
+
+/**
+ *   @brief   Schedules the next wave.
+ *   @details The wave is started by updateGameStates once it is due.
+ *   @return  void
+ */
+void SpaceInvadersGame::scheduleNextWave(double delay)
+{
+  wave_timer = events.after(delay, [this]() { wave_due = true; });
+}
+
+/**
+ *   @brief   Schedules an enemy shot's next firing.
+ *   @details Each shot fires from a random ship at random intervals. A
+ *            shot still in flight, or one picked to fire from a dead
+ *            ship, waits for its next turn.
+ *   @return  void
+ */
+void SpaceInvadersGame::scheduleEnemyShot(int shot)
+{
+  float blend = static_cast<float>(std::rand()) / RAND_MAX;
+  scheduleEnemyShot(shot,
+                    ENEMY_FIRE_MIN + (ENEMY_FIRE_MAX - ENEMY_FIRE_MIN) * blend);
+}
+
+void SpaceInvadersGame::scheduleEnemyShot(int shot, double delay)
+{
+  shot_timers[shot] = events.after(delay, [this, shot]() {
+    int random_enemy = std::rand() % ship_count;
+    if (!enemy_shots[shot].visible() && ships[random_enemy].visible())
+    {
+      fireEnemyShot(shot, random_enemy);
+    }
+    scheduleEnemyShot(shot);
+  });
+}
+
+/**
+ *   @brief   Fires an enemy shot from below a ship.
+ *   @return  void
+ */
+void SpaceInvadersGame::fireEnemyShot(int shot, int ship)
+{
+  rect bounds = shipBounds(ship);
+  float new_x = bounds.x + bounds.length / 2;
+  float new_y = bounds.y + bounds.height + 5;
+  enemy_shots[shot].spriteComponent()->getSprite()->xPos(new_x);
+  enemy_shots[shot].spriteComponent()->getSprite()->yPos(new_y);
+  enemy_shots[shot].setSpeed(SHOT_SPEED);
+  enemy_shots[shot].visible(true);
+}
+
+/**
+ *   @brief   Streams engine exhaust out of the back of the player's ship.
+ *   @details Particles are emitted at a steady rate however long the
+ *            frame was, each drifting a little to either side.
+ *   @return  void
+ */
+void SpaceInvadersGame::emitTrail(float delta_time)
+{
+  const ASGE::Sprite* sprite = player.spriteComponent()->getSprite();
+  float x = sprite->xPos() + (sprite->width() - PARTICLE_SIZE) / 2;
+  float y = sprite->yPos() + sprite->height() - PARTICLE_SIZE;
+
+  trail_timer += delta_time;
+  while (trail_timer >= 1 / TRAIL_RATE)
+  {
+    trail_timer -= 1 / TRAIL_RATE;
+    float drift = static_cast<float>(std::rand()) / RAND_MAX - 0.5f;
+    float speed = static_cast<float>(std::rand()) / RAND_MAX;
+    particles.spawn(x + drift * 8,
+                    y,
+                    drift * 40,
+                    TRAIL_SPEED * (0.6f + 0.4f * speed),
+                    TRAIL_LIFETIME,
+                    ASGE::COLOURS::DEEPSKYBLUE);
+  }
+}
+
+/**
+ *   @brief   Copies the game's state.
+ *   @details Each system copies out only what is in use, so taking a
+ *            snapshot costs about as much as copying the live objects.
+ *   @return  void
+ */
+void SpaceInvadersGame::snapshot(game_state& state)
+{
+  state.game_mode = game_mode;
+  state.score = score;
+  state.current_wave = static_cast<uint32_t>(current_wave);
+  state.endless_loops = endless_loops;
+  state.ship_count = ship_count;
+  state.gameplay_frames = gameplay_frames;
+  state.in_menu = in_menu;
+  state.game_over = game_over;
+  state.game_won = game_won;
+  state.wave_due = wave_due;
+  state.bullet_timer = bullet_timer;
+  state.bullet_angle = bullet_angle;
+  state.trail_timer = trail_timer;
+
+  state.player = player.save();
+  for (int i = 0; i < ship_count; i++)
+  {
+    state.ships[i] = ships[i].save();
+  }
+  for (int i = 0; i < NUM_OF_SHOTS; i++)
+  {
+    state.player_shots[i] = player_shots[i].save();
+    state.enemy_shots[i] = enemy_shots[i].save();
+  }
+  state.formation = formation.save();
+  dives.save(state.dives);
+  scripts.save(state.scripts, { &dive_script });
+
+  state.events = events.clock();
+  state.wave_timer = events.remaining(wave_timer);
+  for (int i = 0; i < NUM_OF_SHOTS; i++)
+  {
+    state.shot_timers[i] = events.remaining(shot_timers[i]);
+  }
+
+  flock.save(state.flock);
+  bullets.save(state.bullets);
+}
+
+/**
+ *   @brief   Puts the game back into a saved state.
+ *   @details Ship sprites only need setting up again when the state is
+ *            from a different wave, otherwise everything is copied back
+ *            in. Timers are scheduled again for the ticks they had left
+ *            on their wheel's restored clock, so they fire exactly when
+ *            they would have. Particles are only for show, so any left
+ *            over are cleared rather than saved.
+ *   @return  False if the state's wave is unknown or not loaded yet.
+ */
+bool SpaceInvadersGame::restore(const game_state& state)
+{
+  const wave_definition* wave = waves.wave(state.current_wave);
+  if (!wave || state.game_mode < 0 || state.game_mode >= NUM_OF_MODES)
+  {
+    return false;
+  }
+
+  game_mode = state.game_mode;
+  bot_playing = bot_playing && botMode();
+  endless_loops = state.endless_loops;
+  if (state.current_wave != current_wave && !placeWave(*wave))
+  {
+    return false;
+  }
+
+  current_wave = state.current_wave;
+  score = state.score;
+  gameplay_frames = state.gameplay_frames;
+  in_menu = state.in_menu;
+  game_over = state.game_over;
+  game_won = state.game_won;
+  wave_due = state.wave_due;
+  bullet_timer = state.bullet_timer;
+  bullet_angle = state.bullet_angle;
+  trail_timer = state.trail_timer;
+
+  player.restore(state.player);
+  for (int i = 0; i < ship_count; i++)
+  {
+    ships[i].restore(state.ships[i]);
+  }
+  for (int i = 0; i < NUM_OF_SHOTS; i++)
+  {
+    player_shots[i].restore(state.player_shots[i]);
+    enemy_shots[i].restore(state.enemy_shots[i]);
+  }
+  formation.restore(state.formation);
+  dives.restore(state.dives);
+  scripts.restore(state.scripts, ship_count, { &dive_script });
+
+  events.clock(state.events);
+  wave_timer = timer_handle{};
+  if (state.wave_timer > 0)
+  {
+    scheduleNextWave(state.wave_timer * TIMER_TICK);
+  }
+  for (int i = 0; i < NUM_OF_SHOTS; i++)
+  {
+    shot_timers[i] = timer_handle{};
+    if (state.shot_timers[i] > 0)
+    {
+      scheduleEnemyShot(i, state.shot_timers[i] * TIMER_TICK);
+    }
+  }
+
+  flock.restore(state.flock);
+  bullets.restore(state.bullets);
+  particles.clear();
+  return true;
+}
+
+/**
+ *   @brief   Saves the game to the quick save file.
+ *   @return  void
+ */
+void SpaceInvadersGame::quickSave()
+{
+  snapshot(*saved_state);
+  if (!saveState(QUICKSAVE_FILE, *saved_state))
+  {
+    std::cout << "Unable to write " << QUICKSAVE_FILE << std::endl;
+  }
+}
+
+/**
+ *   @brief   Loads the game from the quick save file.
+ *   @details The file is read into the spare state first, so a missing
+ *            or broken file leaves the game as it was.
+ *   @return  void
+ */
+void SpaceInvadersGame::quickLoad()
+{
+  if (!loadState(QUICKSAVE_FILE, *saved_state) || !restore(*saved_state))
+  {
+    std::cout << "Unable to load " << QUICKSAVE_FILE << std::endl;
+    return;
+  }
+  rewind_history.clear();
+  rewind_clock = 0;
+}
+
+/**
+ *   @brief   Adds the frame just played to the rewind history.
+ *   @details Frames are recorded at most once a REWIND_TICK, each with
+ *            the time since the last, so the history covers the same
+ *            length of time at any frame rate. The state is encoded in
+ *            the saved game format, which only holds what is in use, and
+ *            the history stores how that differs from its last keyframe.
+ *            Nothing is recorded in the modes that cannot be rewound.
+ *            Recording is a linear pass over the rest of the live state,
+ *            costs about the same each frame, keyframe or not, and never
+ *            allocates.
+ *   @return  void
+ */
+void SpaceInvadersGame::recordFrame(double delta_time)
+{
+  rewind_clock += delta_time;
+  if (!rewindMode() || rewind_clock < REWIND_TICK)
+  {
+    return;
+  }
+
+  snapshot(*saved_state);
+  writeState(*saved_state, rewind_frame);
+  rewind_history.record(
+    rewind_frame.data(), rewind_frame.size(), rewind_clock);
+  rewind_clock = 0;
+}
+
+/**
+ *   @brief   Steps the game back by the time the frame took.
+ *   @details Called each frame while rewinding, in place of playing the
+ *            frame, so the game runs backwards at the speed it was
+ *            played. Time left over from frames that were not stepped
+ *            back to is carried on to the next. Once the history runs
+ *            out the game holds on the oldest frame kept. Rewinding past
+ *            the end of a game lets the player carry on from before they
+ *            lost.
+ *   @return  void
+ */
+void SpaceInvadersGame::rewindFrame(double delta_time)
+{
+  rewind_backlog += delta_time;
+  double stepped = rewind_history.pop(rewind_backlog, rewind_frame);
+  rewind_backlog = rewind_history.frames() > 0 ? rewind_backlog - stepped : 0;
+
+  if (stepped > 0 &&
+      readState(rewind_frame.data(), rewind_frame.size(), *saved_state))
+  {
+    restore(*saved_state);
+  }
+  rewind_clock = 0;
+}
+
+/**
+ *   @brief   Describes the game as a headless simulation.
+ *   @details Ships are placed relative to the formation, which turns
+ *            on the ships' slots as it does in the game. Only the modes
+ *            botMode() allows are described faithfully; in the others
+ *            ships are held still where they are. An enemy shot with no
+ *            timer running never fires.
+ *   @return  void
+ */
+void SpaceInvadersGame::simulation(sim_layout& layout, sim_state& state)
+{
+  const ASGE::Sprite* player_sprite = player.spriteComponent()->getSprite();
+  const ASGE::Sprite* shot_sprite =
+    player_shots[0].spriteComponent()->getSprite();
+  layout.width = static_cast<float>(game_width);
+  layout.height = static_cast<float>(game_height);
+  layout.player_width = player_sprite->width();
+  layout.player_height = player_sprite->height();
+  layout.player_speed = player.getSpeed();
+  layout.shot_width = shot_sprite->width();
+  layout.shot_height = shot_sprite->height();
+  layout.shot_speed = player_shots[0].getSpeed();
+  layout.fire_min = ENEMY_FIRE_MIN;
+  layout.fire_max = ENEMY_FIRE_MAX;
+  layout.formation = formationMode();
+  layout.player_mask = player_mask;
+  layout.player_shot_mask = player_shot_mask;
+  layout.enemy_shot_mask = enemy_shot_mask;
+
+  state.formation = formationMode() ? formation.save() : formation_snapshot{};
+  float origin_x = state.formation.origin_x;
+  float origin_y = state.formation.origin_y;
+
+  layout.ship_count = ship_count;
+  state.ships_left = 0;
+  float left = 0;
+  float right = 0;
+  float top = 0;
+  float bottom = 0;
+  for (int i = 0; i < ship_count; i++)
+  {
+    rect ship = shipBounds(i);
+    float slot_x = formationMode() ? formation.x(i) - origin_x : ship.x;
+    layout.slot_xs[i] = ship.x - origin_x;
+    layout.slot_ys[i] = ship.y - origin_y;
+    layout.ship_width = ship.length;
+    layout.ship_height = ship.height;
+    layout.ship_masks[i] = ship_masks[i];
+    if (i == 0)
+    {
+      layout.left_offset = layout.right_offset = slot_x;
+      left = right = layout.slot_xs[i];
+      top = bottom = layout.slot_ys[i];
+    }
+    layout.left_offset = std::min(layout.left_offset, slot_x);
+    layout.right_offset = std::max(layout.right_offset, slot_x);
+    left = std::min(left, layout.slot_xs[i]);
+    right = std::max(right, layout.slot_xs[i]);
+    top = std::min(top, layout.slot_ys[i]);
+    bottom = std::max(bottom, layout.slot_ys[i]);
+
+    state.ships[i] = ships[i].visible();
+    state.ships_left += state.ships[i] ? 1 : 0;
+  }
+
+  // shots are pruned by where the ships are, dives and all
+  layout.ship_area.x = left;
+  layout.ship_area.y = top;
+  layout.ship_area.length = right - left + layout.ship_width;
+  layout.ship_area.height = bottom - top + layout.ship_height;
+
+  state.player_x = player_sprite->xPos();
+  state.player_y = player_sprite->yPos();
+  for (int i = 0; i < NUM_OF_SHOTS; i++)
+  {
+    const ASGE::Sprite* player_shot =
+      player_shots[i].spriteComponent()->getSprite();
+    state.player_shots[i] = player_shots[i].visible();
+    state.player_shot_xs[i] = player_shot->xPos();
+    state.player_shot_ys[i] = player_shot->yPos();
+
+    const ASGE::Sprite* enemy_shot =
+      enemy_shots[i].spriteComponent()->getSprite();
+    state.enemy_shots[i] = enemy_shots[i].visible();
+    state.enemy_shot_xs[i] = enemy_shot->xPos();
+    state.enemy_shot_ys[i] = enemy_shot->yPos();
+    state.fire_timers[i] =
+      events.active(shot_timers[i])
+        ? static_cast<float>(events.remaining(shot_timers[i]) * TIMER_TICK)
+        : NO_FIRE_TIMER;
+  }
+
+  state.score = score;
+  state.game_over = false;
+  state.wave_cleared = false;
+}
+
+/**
+ *   @brief   Lets the bot play this frame.
+ *   @details The bot's action is played as if its keys were pressed,
+ *            holding a direction and firing if a shot is free.
+ *   @return  void
+ */
+void SpaceInvadersGame::playBot()
+{
+  simulation(bot_layout, bot_state);
+  uint8_t action = bot.choose(bot_layout, bot_state, &workers);
+
+  float direction = 0;
+  if (action & ACTION_LEFT)
+  {
+    direction = -1;
+  }
+  else if (action & ACTION_RIGHT)
+  {
+    direction = 1;
+  }
+  player.direction(direction, 0);
+
+  if (action & ACTION_FIRE)
+  {
+    firePlayerShot();
+  }
+}
+
+/**
+ *   @brief   Prints what the last frame drew.
+ *   @details Shows how many sprites the render queue culled and how
+ *            many texture changes sorting saved. Bullets, boids and
+ *            particles are drawn directly, each with one shared sprite,
+ *            so they are counted separately.
+ *   @return  void
+ */
+void SpaceInvadersGame::reportRenderStats()
+{
+  size_t direct = particles.size();
+  if (game_mode == BULLET_HELL_MODE)
+  {
+    direct += bullets.size();
+  }
+  else if (game_mode == FLOCK_MODE)
+  {
+    direct += flock.size();
+  }
+
+  ASGE::DebugPrinter{} << "Queued " << render_queue.submitted()
+                       << " sprites, culled " << render_queue.culled()
+                       << ", texture changes "
+                       << render_queue.textureChanges() << " (unsorted "
+                       << render_queue.unsortedTextureChanges()
+                       << "), drawn directly " << direct << std::endl;
+}
+
 /**
  *   @brief   Updates the scene
  *   @details Prepares the renderer subsystem before drawing the
@@ -480,33 +1756,81 @@ void SpaceInvadersGame::update(const ASGE::GameTime& game_time)
   // auto dt_sec = game_time.delta.count() / 1000.0;;
   // make sure you use delta time in any movement calculations!
 
-  if (!in_menu && !game_over && !game_won)
+  AllocationZone zone("update");
+
+  // the engine's delta covers any time the last frame spent idle, which
+  // play resuming from a static screen must not see as one long frame
+  double elapsed = frame_scheduler.delta(game_time.delta.count()) / 1000.0;
+
+  // nothing moves on the menu or end screens once loading is done
+  frame_scheduler.wait(asset_loader.finished() && !rewinding &&
+                       (in_menu || game_over || game_won));
+  frame_start = std::chrono::steady_clock::now();
+
+  if (!asset_loader.finished())
   {
+    if (!loadAssets())
+    {
+      signalExit();
+    }
+    return;
+  }
+
+  if (soaking && in_menu)
+  {
+    startGameplay();
+    in_menu = false;
+  }
+
+  if (!in_menu && rewinding)
+  {
+    // going back to an earlier wave sets its ships up again, which
+    // allocates, so rewinding is not part of the check
+    rewindFrame(elapsed);
+  }
+  else if (!in_menu && !game_over && !game_won)
+  {
+    // starting a new wave allocates, so this comes before the check
+    events.advance(elapsed);
+    if (soaking)
+    {
+      clearSoakWave();
+    }
     updateGameStates();
+    streamNextWave();
+
+    // once gameplay has settled, a frame should never allocate
+    NoAllocationScope no_allocations(gameplay_frames++ >=
+                                     STEADY_STATE_FRAMES);
+
+    if (bot_playing)
+    {
+      playBot();
+    }
 
-    moveObjects(game_time.delta.count() / 1000.0f);
+    moveObjects(elapsed);
 
     shotCollision();
 
-    // Spawn Enemy Shots
-    for (int i = 0; i < NUM_OF_SHOTS; i++)
-    {
-      int random_enemy = std::rand() % (NUM_OF_SHIPS);
+    auto delta_time = static_cast<float>(elapsed);
+    emitTrail(delta_time);
+    particles.update(delta_time);
+
+    scripts.update(delta_time);
 
-      if (ships[random_enemy].visible() && std::rand() % 50000000 + 1 < 2)
+    if (game_mode == BULLET_HELL_MODE)
+    {
+      fireBullets(delta_time);
+      bullets.update(delta_time);
+      if (bullets.hits(player.spriteComponent()->getBoundingBox(),
+                       player_mask,
+                       bullet_mask))
       {
-        float new_x =
-          ships[random_enemy].spriteComponent()->getSprite()->xPos() +
-          ships[random_enemy].spriteComponent()->getSprite()->width() / 2;
-        float new_y =
-          ships[random_enemy].spriteComponent()->getSprite()->yPos() +
-          ships[random_enemy].spriteComponent()->getSprite()->height() + 5;
-        enemy_shots[i].spriteComponent()->getSprite()->xPos(new_x);
-        enemy_shots[i].spriteComponent()->getSprite()->yPos(new_y);
-        enemy_shots[i].setSpeed(200);
-        enemy_shots[i].visible(true);
+        game_over = true;
       }
     }
+
+    recordFrame(elapsed);
   }
 }
 
@@ -517,35 +1841,54 @@ void SpaceInvadersGame::update(const ASGE::GameTime& game_time)
  *            swapped accordingly and the image shown.
  *   @return  void
  */
-void SpaceInvadersGame::render(const ASGE::GameTime&)
+void SpaceInvadersGame::render(const ASGE::GameTime& game_time)
 {
+  AllocationZone zone("render");
   renderer->setFont(0);
 
   if (in_menu)
   {
-    renderer->renderText(
-      "Please choose a mode, press ENTER to continue", 70, 260);
-
-    renderer->renderText(game_mode == 0 ? ">> Normal" : "   Normal", 260, 350);
-
-    renderer->renderText(
-      game_mode == 1 ? ">> Gravity" : "   Gravity", 255, 400);
-
-    renderer->renderText(
-      game_mode == 2 ? ">> Quadratic Curve" : "   Quadratic Curve", 210, 450);
+    if (asset_loader.finished())
+    {
+      text.render(renderer.get(), menu_text);
+    }
+    else
+    {
+      int progress = static_cast<int>(asset_loader.progress() * 100);
+      if (progress != shown_progress)
+      {
+        char loading_txt[32];
+        std::snprintf(
+          loading_txt, sizeof(loading_txt), "Loading... %d%%", progress);
+        text.set(loading_text, loading_txt);
+        shown_progress = progress;
+      }
+      text.render(renderer.get(), loading_text);
+    }
 
-    renderer->renderText(
-      game_mode == 3 ? ">> Sine Curve" : "   Sine Curve", 240, 500);
+    for (int i = 0; i < NUM_OF_MODES; i++)
+    {
+      text.render(renderer.get(), mode_text[i][game_mode == i ? 1 : 0]);
+    }
   }
   else
   {
-    renderer->renderSprite(*player.spriteComponent()->getSprite());
+    render_queue.begin();
+    render_queue.add(*player.spriteComponent()->getSprite(),
+                     RenderLayer::PLAYER);
 
-    for (int i = 0; i < NUM_OF_SHIPS; i++)
+    for (int i = 0; i < ship_count; i++)
     {
       if (ships[i].visible())
       {
-        renderer->renderSprite(*ships[i].spriteComponent()->getSprite());
+        ASGE::Sprite* sprite = ships[i].spriteComponent()->getSprite();
+        if (formationMode())
+        {
+          rect ship = shipBounds(i);
+          sprite->xPos(ship.x);
+          sprite->yPos(ship.y);
+        }
+        render_queue.add(*sprite, RenderLayer::SHIPS);
       }
     }
 
@@ -553,35 +1896,62 @@ void SpaceInvadersGame::render(const ASGE::GameTime&)
     {
       if (player_shots[i].visible())
       {
-        renderer->renderSprite(*player_shots[i].spriteComponent()->getSprite());
+        render_queue.add(*player_shots[i].spriteComponent()->getSprite(),
+                         RenderLayer::SHOTS);
       }
-    }
 
-    for (int i = 0; i < NUM_OF_SHOTS; i++)
-    {
       if (enemy_shots[i].visible())
       {
-        renderer->renderSprite(*enemy_shots[i].spriteComponent()->getSprite());
+        render_queue.add(*enemy_shots[i].spriteComponent()->getSprite(),
+                         RenderLayer::SHOTS);
       }
     }
+    render_queue.submit(renderer.get(), frame_arena);
 
-    std::string score_txt = "Score: ";
-    score_txt += std::to_string(score);
-    renderer->renderText(score_txt, 525, 50, 1, ASGE::COLOURS::WHITE);
+    if (game_mode == BULLET_HELL_MODE)
+    {
+      bullets.render(renderer.get(), *bullet.spriteComponent()->getSprite());
+    }
+    else if (game_mode == FLOCK_MODE)
+    {
+      flock.render(renderer.get(), *boid.spriteComponent()->getSprite());
+    }
+    particles.render(renderer.get(), *particle.spriteComponent()->getSprite());
+
+    if (score != shown_score)
+    {
+      char score_txt[32];
+      std::snprintf(score_txt, sizeof(score_txt), "Score: %d", score);
+      text.set(score_text, score_txt);
+      shown_score = score;
+    }
+    text.render(renderer.get(), score_text);
+    if (!rewindMode())
+    {
+      text.render(renderer.get(), no_rewind_text);
+    }
 
     if (game_won)
     {
-      renderer->renderText("Congratulations!", 230, 450);
-      renderer->renderText(
-        "You have saved the human race from destruction!", 70, 470);
+      for (auto line : won_text)
+      {
+        text.render(renderer.get(), line);
+      }
     }
     else if (game_over)
     {
-      renderer->renderText("You've Lost...", 235, 440);
-      renderer->renderText(
-        "You have single handily managed to cause the", 80, 460);
-      renderer->renderText(
-        "desolation of human kind due to your incompetence", 50, 480);
+      for (auto line : lost_text)
+      {
+        text.render(renderer.get(), line);
+      }
     }
   }
+
+  // render is the last thing each frame, so nothing transient is left
+  frame_arena.reset();
+  AllocationTracker::endFrame(game_time.delta.count());
+  if (soaking && !in_menu)
+  {
+    reportSoak(game_time.delta.count() / 1000.0);
+  }
 }
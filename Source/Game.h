@@ -1,14 +1,79 @@
 #pragma once
 #include <Engine/OGLGame.h>
+#include <chrono>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "Components/Formation.h"
 #include "Components/GameObjectController.h"
+#include "GameState.h"
+#include "MonteCarloPlayer.h"
+#include "Simulation.h"
+#include "Utility/AllocationTracker.h"
+#include "Utility/AssetArchive.h"
+#include "Utility/AssetLoader.h"
+#include "Utility/DiveSystem.h"
+#include "Utility/FrameArena.h"
+#include "Utility/Flock.h"
+#include "Utility/FrameScheduler.h"
+#include "Utility/MaskLibrary.h"
+#include "Utility/ParticleSystem.h"
+#include "Utility/ProjectileSystem.h"
 #include "Utility/Rect.h"
+#include "Utility/RenderQueue.h"
+#include "Utility/RewindBuffer.h"
+#include "Utility/Script.h"
+#include "Utility/SoakMonitor.h"
+#include "Utility/SpriteAtlas.h"
+#include "Utility/TextCache.h"
+#include "Utility/TextureCache.h"
+#include "Utility/TimerWheel.h"
+#include "Utility/WaveLibrary.h"
+#include "Utility/WorkerPool.h"
 
-const int NUM_OF_SHIPS = 40;
-const int COLUMNS = 8;
-const int ROWS = NUM_OF_SHIPS / COLUMNS;
-const int NUM_OF_SHOTS = 10;
+const int NUM_OF_MODES = 7;
+const int ENDLESS_MODE = 4;
+const int BULLET_HELL_MODE = 5;
+const int FLOCK_MODE = 6;
+const float ENDLESS_SPEEDUP = 0.1f;
+const int ENDLESS_MAX_SPEEDUPS = 10;
+const float BULLET_SIZE = 8;
+const float BULLET_SPEED = 100;
+const int BULLET_RING = 32;
+const float BULLET_INTERVAL = 0.1f;
+const float BULLET_SPIN = 0.3f;
+const float DIVE_SPEED = 300;
+const size_t MAX_PARTICLES = 65536;
+const float PARTICLE_SIZE = 6;
+const int EXPLOSION_PARTICLES = 48;
+const float EXPLOSION_SPEED = 220;
+const float EXPLOSION_LIFETIME = 0.8f;
+const float TRAIL_RATE = 90;
+const float TRAIL_SPEED = 120;
+const float TRAIL_LIFETIME = 0.35f;
+const float WAVE_DELAY = 1.5f;
+const size_t MAX_EVENTS = 32;
+const float BOID_SIZE = 16;
+const float FLOCK_SPAWN_HEIGHT = 300;
+// the player, the shared bullet, particle and boid sprites, ships and shots
+const int NUM_OF_SPRITES = 4 + MAX_SHIPS + NUM_OF_SHOTS * 2;
+const std::chrono::microseconds ASSET_LOAD_BUDGET{ 4000 };
+// the time a gameplay frame may spend loading the next wave's textures
+const std::chrono::microseconds WAVE_LOAD_BUDGET{ 1000 };
+const size_t FRAME_ARENA_SIZE = 64 * 1024;
+const int STEADY_STATE_FRAMES = 60;
+const char QUICKSAVE_FILE[] = "quicksave.sav";
+// room for REWIND_SECONDS of a full wave, recorded every REWIND_TICK
+const size_t REWIND_BYTES = 1024 * 1024;
+const double REWIND_SECONDS = 10;
+// frames are recorded at most this often, however fast the game runs
+const double REWIND_TICK = 1.0 / 120;
+// enough frames for REWIND_SECONDS of ticks
+const size_t REWIND_FRAMES = 1200;
+const int REWIND_KEYFRAME_INTERVAL = 30;
+// futures the bot tries per action for each thread it can use
+const int BOT_ROLLOUTS_PER_THREAD = 32;
 
 /**
  *  An OpenGL Game based on ASGE.
@@ -20,18 +85,61 @@ class SpaceInvadersGame : public ASGE::OGLGame
   ~SpaceInvadersGame();
   virtual bool init() override;
 
+  /**
+   *  Plays endless mode unattended, clearing each wave as it spawns.
+   *  Call before init(). Reports the spawn rate and frame time once a
+   *  minute to the console.
+   *  @param [in] minutes How long to play before exiting, 0 for ever
+   */
+  void soak(double minutes);
+
  private:
   void keyHandler(const ASGE::SharedEventData data);
   void clickHandler(const ASGE::SharedEventData data);
   void setupResolution();
 
-  bool setupObjects();
+  void setupText();
+  void setupObjects();
+  bool setupShip(int index, const wave_definition& wave);
+  size_t nextWaveIndex() const;
+  bool nextWave();
+  void streamNextWave();
+  bool placeWave(const wave_definition& wave);
+  float waveSpeed(const wave_definition& wave) const;
+  const CollisionMask* objectMask(GameObject* object, const std::string& file);
+  bool formationMode() const;
+  bool rewindMode() const;
+  bool botMode() const;
+  rect shipBounds(int index);
+  void moveShips(double delta_time);
+  bool loadAssets();
   void updateGameStates();
   void moveObjects(double delta_time);
   void shotCollision();
+  void fireBullets(float delta_time);
+  void emitTrail(float delta_time);
+  void fireEnemyShot(int shot, int ship);
+  void setupDivePaths();
+  void setupScripts();
+  void startScripts();
+  void startGameplay();
+  void spawnFlock();
+  void scheduleNextWave(double delay);
+  void scheduleEnemyShot(int shot);
+  void scheduleEnemyShot(int shot, double delay);
+  void snapshot(game_state& state);
+  bool restore(const game_state& state);
+  void quickSave();
+  void quickLoad();
+  void recordFrame(double delta_time);
+  void rewindFrame(double delta_time);
+  void firePlayerShot();
+  void clearSoakWave();
+  void reportSoak(double delta_time);
+  void simulation(sim_layout& layout, sim_state& state);
+  void playBot();
+  void reportRenderStats();
 
-  void
-  normalEnemyMovement(float prev_dir, float enemy_direction, double delta_time);
   void gravityEnemyMovement(double delta_time);
   void quadraticEnemyMovement(double delta_time);
   void sinEnemyMovement(double delta_time);
@@ -43,16 +151,86 @@ class SpaceInvadersGame : public ASGE::OGLGame
   int mouse_callback_id = -1; /**< Mouse Input Callback ID. */
 
   GameObjectController controller;
+  ObjectPool<SpriteComponent> sprite_components;
+  ObjectPool<SpriteComponent> ship_components; /**< Emptied every wave. */
+  AssetArchive archive;
+  AssetLoader asset_loader;
+  AssetLoader wave_loader;
+  SpriteComponent wave_textures;
+  size_t streamed_wave = 0;
+  TextureCache texture_cache;
+  SpriteAtlas sprite_atlas;
+  MaskLibrary masks;
+  FrameArena frame_arena;
+  RenderQueue render_queue;
+  WaveLibrary waves;
+  ProjectileSystem bullets;
+  FrameScheduler frame_scheduler;
+  WorkerPool workers;
+
+  // Text
+  TextCache text;
+  TextCache::Id menu_text = 0;
+  TextCache::Id loading_text = 0;
+  TextCache::Id mode_text[NUM_OF_MODES][2] = {};
+  TextCache::Id score_text = 0;
+  TextCache::Id no_rewind_text = 0;
+  TextCache::Id won_text[2] = {};
+  TextCache::Id lost_text[3] = {};
+  int shown_score = 0;
+  int shown_progress = 0;
 
   // GameObjects
   GameObject player;
-  GameObject ships[NUM_OF_SHIPS];
+  GameObject ships[MAX_SHIPS];
+  int ship_rows[MAX_SHIPS] = {};
+  const std::string* ship_textures[MAX_SHIPS] = {};
+  const CollisionMask* ship_masks[MAX_SHIPS] = {};
+  const CollisionMask* player_mask = nullptr;
+  const CollisionMask* player_shot_mask = nullptr;
+  const CollisionMask* enemy_shot_mask = nullptr;
+  const CollisionMask* bullet_mask = nullptr;
+  const CollisionMask* boid_mask = nullptr;
+  int ship_count = 0;
+  Formation formation;
+  DiveSystem dives;
+  Script dive_script;
+  ScriptRunner scripts;
+  TimerWheel events;
+  timer_handle wave_timer;
+  timer_handle shot_timers[NUM_OF_SHOTS];
+  bool wave_due = false;
+  size_t current_wave = 0;
+  int endless_loops = 0;
   GameObject player_shots[NUM_OF_SHOTS];
   GameObject enemy_shots[NUM_OF_SHOTS];
+  GameObject bullet;
+  float bullet_timer = 0;
+  float bullet_angle = 0;
+  ParticleSystem particles;
+  GameObject particle;
+  float trail_timer = 0;
+  Flock flock;
+  GameObject boid;
 
   bool in_menu = true;
   bool game_over = false;
   bool game_won = false;
   int score = 0;
   int game_mode = 0;
+  int gameplay_frames = 0;
+  std::unique_ptr<game_state> saved_state;
+  RewindBuffer rewind_history;
+  std::vector<char> rewind_frame;
+  double rewind_clock = 0;   /**< Seconds since the last frame recorded. */
+  double rewind_backlog = 0; /**< Seconds still to step back. */
+  bool rewinding = false;
+  MonteCarloPlayer bot;
+  sim_layout bot_layout;
+  sim_state bot_state;
+  bool bot_playing = false;
+  bool soaking = false;
+  double soak_minutes = 0;
+  SoakMonitor soak_monitor;
+  std::chrono::steady_clock::time_point frame_start;
 };
\ No newline at end of file
@@ -0,0 +1,344 @@
+#include "GameState.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <type_traits>
+
+/**
+ *   @brief   Appends the bytes of plain values to a buffer.
+ *   @details Only numbers and bools are written as raw bytes. Structs
+ *            are written a field at a time, so their padding never
+ *            reaches the encoded state.
+ *   @return  void
+ */
+template <typename T>
+static void put(std::vector<char>& buffer, const T* values, size_t count)
+{
+  static_assert(std::is_arithmetic<T>::value,
+                "structs must be written a field at a time");
+  const char* bytes = reinterpret_cast<const char*>(values);
+  buffer.insert(buffer.end(), bytes, bytes + sizeof(T) * count);
+}
+
+template <typename T>
+static void put(std::vector<char>& buffer, const T& value)
+{
+  put(buffer, &value, 1);
+}
+
+/**
+ *  Reads plain values back out of an encoded state, checking each read
+ *  stays inside the data. Once a read fails every later read fails too.
+ */
+class StateReader
+{
+ public:
+  StateReader(const char* state_data, size_t state_size) :
+    data(state_data), size(state_size)
+  {
+  }
+
+  template <typename T> bool get(T* values, size_t count)
+  {
+    static_assert(std::is_arithmetic<T>::value,
+                  "structs must be read a field at a time");
+    size_t bytes = sizeof(T) * count;
+    if (!valid || size - offset < bytes)
+    {
+      valid = false;
+      return false;
+    }
+    std::memcpy(values, data + offset, bytes);
+    offset += bytes;
+    return true;
+  }
+
+  template <typename T> bool get(T& value) { return get(&value, 1); }
+
+  /**
+   *  Reads a bool, failing unless its byte is 0 or 1.
+   */
+  bool getFlag(bool& flag)
+  {
+    uint8_t byte = 0;
+    valid = get(byte) && byte <= 1;
+    flag = byte == 1;
+    return valid;
+  }
+
+  /**
+   *  Reads a count, failing if it is larger than an array can hold.
+   */
+  bool getCount(uint32_t& count, size_t capacity)
+  {
+    valid = get(count) && count <= capacity;
+    return valid;
+  }
+
+  bool finished() const { return valid && offset == size; }
+
+ private:
+  const char* data = nullptr;
+  size_t size = 0;
+  size_t offset = 0;
+  bool valid = true;
+};
+
+static void put(std::vector<char>& buffer,
+                const object_snapshot* objects,
+                size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    put(buffer, objects[i].x);
+    put(buffer, objects[i].y);
+    put(buffer, objects[i].direction_x);
+    put(buffer, objects[i].direction_y);
+    put(buffer, objects[i].speed);
+    put(buffer, objects[i].visible);
+  }
+}
+
+static void get(StateReader& reader, object_snapshot* objects, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    reader.get(objects[i].x);
+    reader.get(objects[i].y);
+    reader.get(objects[i].direction_x);
+    reader.get(objects[i].direction_y);
+    reader.get(objects[i].speed);
+    reader.getFlag(objects[i].visible);
+  }
+}
+
+static void put(std::vector<char>& buffer, const timer_clock& clock)
+{
+  put(buffer, clock.now);
+  put(buffer, clock.carry);
+}
+
+static void get(StateReader& reader, timer_clock& clock)
+{
+  reader.get(clock.now);
+  reader.get(clock.carry);
+}
+
+static void put(std::vector<char>& buffer, const formation_snapshot& formation)
+{
+  put(buffer, formation.origin_x);
+  put(buffer, formation.origin_y);
+  put(buffer, formation.direction);
+  put(buffer, formation.speed);
+}
+
+static void get(StateReader& reader, formation_snapshot& formation)
+{
+  reader.get(formation.origin_x);
+  reader.get(formation.origin_y);
+  reader.get(formation.direction);
+  reader.get(formation.speed);
+}
+
+static void put(std::vector<char>& buffer,
+                const running_script* scripts,
+                size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    put(buffer, scripts[i].script);
+    put(buffer, scripts[i].ship);
+    put(buffer, scripts[i].step);
+    put(buffer, scripts[i].wake);
+    put(buffer, scripts[i].dive_end);
+  }
+}
+
+static void get(StateReader& reader, running_script* scripts, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    reader.get(scripts[i].script);
+    reader.get(scripts[i].ship);
+    reader.get(scripts[i].step);
+    reader.get(scripts[i].wake);
+    reader.get(scripts[i].dive_end);
+  }
+}
+
+template <size_t N>
+static void put(std::vector<char>& buffer, const motion_snapshot<N>& motion)
+{
+  put(buffer, motion.count);
+  put(buffer, motion.xs, motion.count);
+  put(buffer, motion.ys, motion.count);
+  put(buffer, motion.velocity_xs, motion.count);
+  put(buffer, motion.velocity_ys, motion.count);
+}
+
+template <size_t N>
+static bool get(StateReader& reader, motion_snapshot<N>& motion)
+{
+  return reader.getCount(motion.count, N) &&
+         reader.get(motion.xs, motion.count) &&
+         reader.get(motion.ys, motion.count) &&
+         reader.get(motion.velocity_xs, motion.count) &&
+         reader.get(motion.velocity_ys, motion.count);
+}
+
+/**
+ *   @brief   Encodes a state.
+ *   @details Fields are written one at a time, in order, with every
+ *            array cut down to its entries in use. Structs are never
+ *            copied whole, so the same state always encodes to the same
+ *            bytes. A state mid wave
+ *            with no bullets in flight takes a few kilobytes, where a
+ *            copy of the whole struct would take over a megabyte.
+ *   @return  void
+ */
+void writeState(const game_state& state, std::vector<char>& buffer)
+{
+  buffer.resize(sizeof(StateHeader));
+
+  put(buffer, state.game_mode);
+  put(buffer, state.score);
+  put(buffer, state.current_wave);
+  put(buffer, state.endless_loops);
+  put(buffer, state.ship_count);
+  put(buffer, state.gameplay_frames);
+  put(buffer, state.in_menu);
+  put(buffer, state.game_over);
+  put(buffer, state.game_won);
+  put(buffer, state.wave_due);
+  put(buffer, state.bullet_timer);
+  put(buffer, state.bullet_angle);
+  put(buffer, state.trail_timer);
+
+  int ship_count = std::clamp(state.ship_count, 0, MAX_SHIPS);
+  put(buffer, &state.player, 1);
+  put(buffer, state.ships, static_cast<size_t>(ship_count));
+  put(buffer, state.player_shots, NUM_OF_SHOTS);
+  put(buffer, state.enemy_shots, NUM_OF_SHOTS);
+  put(buffer, state.formation);
+
+  const auto& dives = state.dives;
+  put(buffer, dives.count);
+  put(buffer, dives.slots, dives.count);
+  put(buffer, dives.paths, dives.count);
+  put(buffer, dives.distances, dives.count);
+  put(buffer, dives.speeds, dives.count);
+  put(buffer, dives.mirrors, dives.count);
+
+  put(buffer, state.scripts.clock);
+  put(buffer, state.scripts.count);
+  put(buffer, state.scripts.scripts, state.scripts.count);
+
+  put(buffer, state.events);
+  put(buffer, state.wave_timer);
+  put(buffer, state.shot_timers, NUM_OF_SHOTS);
+
+  put(buffer, state.flock);
+  put(buffer, state.bullets);
+
+  StateHeader header;
+  std::copy(STATE_MAGIC, STATE_MAGIC + 4, header.magic);
+  header.version = STATE_VERSION;
+  header.size = static_cast<uint32_t>(buffer.size() - sizeof(header));
+  std::memcpy(buffer.data(), &header, sizeof(header));
+}
+
+/**
+ *   @brief   Decodes a state.
+ *   @details Reads the fields back in the order they were written. The
+ *            header, every count, every bool and the total size are all
+ *            checked, so a truncated or corrupt file is rejected rather
+ *            than read past its end or left holding invalid bools.
+ *   @return  True if the data held a valid state.
+ */
+bool readState(const char* data, size_t size, game_state& state)
+{
+  StateHeader header;
+  if (size < sizeof(header))
+  {
+    return false;
+  }
+
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, STATE_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != STATE_VERSION ||
+      header.size != size - sizeof(header))
+  {
+    return false;
+  }
+
+  StateReader reader(data + sizeof(header), header.size);
+  reader.get(state.game_mode);
+  reader.get(state.score);
+  reader.get(state.current_wave);
+  reader.get(state.endless_loops);
+  reader.get(state.ship_count);
+  reader.get(state.gameplay_frames);
+  reader.getFlag(state.in_menu);
+  reader.getFlag(state.game_over);
+  reader.getFlag(state.game_won);
+  reader.getFlag(state.wave_due);
+  reader.get(state.bullet_timer);
+  reader.get(state.bullet_angle);
+  reader.get(state.trail_timer);
+
+  if (state.ship_count < 0 || state.ship_count > MAX_SHIPS)
+  {
+    return false;
+  }
+  get(reader, &state.player, 1);
+  get(reader, state.ships, static_cast<size_t>(state.ship_count));
+  get(reader, state.player_shots, NUM_OF_SHOTS);
+  get(reader, state.enemy_shots, NUM_OF_SHOTS);
+  get(reader, state.formation);
+
+  auto& dives = state.dives;
+  reader.getCount(dives.count, MAX_SHIPS);
+  reader.get(dives.slots, dives.count);
+  reader.get(dives.paths, dives.count);
+  reader.get(dives.distances, dives.count);
+  reader.get(dives.speeds, dives.count);
+  reader.get(dives.mirrors, dives.count);
+
+  get(reader, state.scripts.clock);
+  reader.getCount(state.scripts.count, MAX_SHIPS);
+  get(reader, state.scripts.scripts, state.scripts.count);
+
+  get(reader, state.events);
+  reader.get(state.wave_timer);
+  reader.get(state.shot_timers, NUM_OF_SHOTS);
+
+  get(reader, state.flock);
+  get(reader, state.bullets);
+  return reader.finished();
+}
+
+bool saveState(const std::string& file_name, const game_state& state)
+{
+  std::vector<char> buffer;
+  writeState(state, buffer);
+
+  std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+  file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+  return static_cast<bool>(file);
+}
+
+bool loadState(const std::string& file_name, game_state& state)
+{
+  std::ifstream file(file_name, std::ios::binary);
+  if (!file)
+  {
+    return false;
+  }
+
+  std::vector<char> buffer((std::istreambuf_iterator<char>(file)),
+                           std::istreambuf_iterator<char>());
+  return readState(buffer.data(), buffer.size(), state);
+}
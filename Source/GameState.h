@@ -0,0 +1,118 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Components/Formation.h"
+#include "Components/GameObject.h"
+#include "Utility/DiveSystem.h"
+#include "Utility/Script.h"
+#include "Utility/Snapshot.h"
+#include "Utility/TimerWheel.h"
+
+// the game's fixed limits, which the saved state is sized by
+const int MAX_SHIPS = 128;
+const int NUM_OF_SHOTS = 10;
+const size_t MAX_BULLETS = 100000;
+const size_t FLOCK_SIZE = 500;
+
+const char STATE_MAGIC[4] = { 'S', 'I', 'S', 'V' };
+const uint32_t STATE_VERSION = 2;
+
+/**
+ *  The header at the start of a saved game.
+ *  It is followed by size bytes holding the game_state's fields in
+ *  order, with each array cut down to the entries in use. Structs are
+ *  stored field by field, without their padding.
+ */
+struct StateHeader
+{
+  char magic[4] = { 0, 0, 0, 0 };
+  uint32_t version = 0;
+  uint32_t size = 0;
+  uint32_t reserved = 0;
+};
+
+static_assert(sizeof(StateHeader) == 16, "state header must be packed");
+
+/**
+ *  Everything needed to carry on a game from where it was.
+ *  Plain data only, so a state is copied with a single assignment and
+ *  never allocates. Sprites, textures and the waves' layouts are not
+ *  part of it, as they are loaded once and only looked up by the state.
+ *  Timers are saved as the ticks they have left, along with their
+ *  wheel's clock. Particles are purely visual and are not saved, nor
+ *  is the standard random number generator the game draws from.
+ *  The largest arrays hold far more entries than are normally in use,
+ *  so the state is big (about 1.6MB) and should live on the heap.
+ */
+struct game_state
+{
+  int32_t game_mode = 0;
+  int32_t score = 0;
+  uint32_t current_wave = 0;
+  int32_t endless_loops = 0;
+  int32_t ship_count = 0;
+  int32_t gameplay_frames = 0;
+  bool in_menu = true;
+  bool game_over = false;
+  bool game_won = false;
+  bool wave_due = false;
+  float bullet_timer = 0;
+  float bullet_angle = 0;
+  float trail_timer = 0;
+
+  object_snapshot player;
+  object_snapshot ships[MAX_SHIPS];
+  object_snapshot player_shots[NUM_OF_SHOTS];
+  object_snapshot enemy_shots[NUM_OF_SHOTS];
+  formation_snapshot formation;
+  dive_snapshot<MAX_SHIPS> dives;
+  script_snapshot<MAX_SHIPS> scripts;
+
+  timer_clock events;
+  uint32_t wave_timer = 0; /**< Ticks until the next wave, 0 if none. */
+  uint32_t shot_timers[NUM_OF_SHOTS] = {};
+
+  motion_snapshot<FLOCK_SIZE> flock;
+  motion_snapshot<MAX_BULLETS> bullets;
+};
+
+static_assert(std::is_trivially_copyable<game_state>::value,
+              "game states must be copyable as plain memory");
+
+/**
+ *  Encodes a state into the saved game format.
+ *  @param [in] state The state to encode
+ *  @param [out] buffer Replaced with the encoded state
+ */
+void writeState(const game_state& state, std::vector<char>& buffer);
+
+/**
+ *  Decodes a state from the saved game format.
+ *  Invalid data may leave the state partly overwritten, so decode into
+ *  a spare state rather than one in use.
+ *  @param [in] data The encoded state
+ *  @param [in] size The size of the encoded state
+ *  @param [out] state The decoded state
+ *  @return false if the data is not a valid saved game
+ */
+bool readState(const char* data, size_t size, game_state& state);
+
+/**
+ *  Writes a state to a file.
+ *  @param [in] file_name The file to write
+ *  @param [in] state The state to save
+ *  @return false if the file could not be written
+ */
+bool saveState(const std::string& file_name, const game_state& state);
+
+/**
+ *  Reads a state from a file.
+ *  @param [in] file_name The file to read
+ *  @param [out] state The loaded state
+ *  @return false if the file is missing or not a valid saved game
+ */
+bool loadState(const std::string& file_name, game_state& state);
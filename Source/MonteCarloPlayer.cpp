@@ -0,0 +1,141 @@
+#include "MonteCarloPlayer.h"
+
+#include <algorithm>
+
+#include "Utility/Hash.h"
+
+// every action the bot can choose between
+const uint8_t BOT_ACTIONS[] = { 0,
+                                ACTION_LEFT,
+                                ACTION_RIGHT,
+                                ACTION_FIRE,
+                                ACTION_LEFT | ACTION_FIRE,
+                                ACTION_RIGHT | ACTION_FIRE };
+const size_t NUM_OF_BOT_ACTIONS = sizeof(BOT_ACTIONS);
+// futures played out per chunk when shared between threads
+const size_t ROLLOUT_CHUNK = 8;
+
+void MonteCarloPlayer::settings(const rollout_settings& new_settings)
+{
+  search = new_settings;
+  search.rollouts = std::max(search.rollouts, 1);
+  search.horizon = std::max(search.horizon, 1);
+  search.hold = std::max(search.hold, 1);
+  results.resize(NUM_OF_BOT_ACTIONS * static_cast<size_t>(search.rollouts));
+}
+
+/**
+ *   @brief   Picks the action to play next.
+ *   @details Every future is stored in its own slot, so no two threads
+ *            write to the same place, and the slots are only added up
+ *            once all of them are done. Ties go to the earliest action
+ *            in the list, which does nothing.
+ *   @return  The ACTION_ bits to play.
+ */
+uint8_t MonteCarloPlayer::choose(const sim_layout& layout,
+                                 const sim_state& state,
+                                 WorkerPool* workers)
+{
+  if (results.empty())
+  {
+    settings(search);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  uint64_t round = decisions++;
+  uint64_t round_seed = hashBytes(&round, sizeof(round));
+  auto rollouts = static_cast<size_t>(search.rollouts);
+  auto job = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++)
+    {
+      uint64_t seed = hashBytes(&i, sizeof(i), round_seed);
+      results[i] = rollout(layout,
+                           state,
+                           BOT_ACTIONS[i / rollouts],
+                           static_cast<uint32_t>(seed) | 1);
+    }
+  };
+  if (workers)
+  {
+    workers->run(results.size(), ROLLOUT_CHUNK, job);
+  }
+  else
+  {
+    job(0, results.size());
+  }
+
+  size_t best = 0;
+  float best_value = -1;
+  for (size_t action = 0; action < NUM_OF_BOT_ACTIONS; action++)
+  {
+    float value = 0;
+    for (size_t i = action * rollouts; i < (action + 1) * rollouts; i++)
+    {
+      value += results[i].value;
+      total_steps += results[i].steps;
+    }
+
+    if (value > best_value)
+    {
+      best = action;
+      best_value = value;
+    }
+  }
+
+  total_time += std::chrono::steady_clock::now() - start;
+  return BOT_ACTIONS[best];
+}
+
+/**
+ *   @brief   Plays out one future.
+ *   @details The action is held for the first few frames, then a random
+ *            action is held for as long, and so on. A future that ends
+ *            in the wave being cleared counts as having survived.
+ *   @return  The future's survival times the score it gained, plus the
+ *            frames it stepped.
+ */
+MonteCarloPlayer::rollout_result
+MonteCarloPlayer::rollout(const sim_layout& layout,
+                          sim_state state,
+                          uint8_t action,
+                          uint32_t seed) const
+{
+  state.random = seed;
+  uint32_t policy = nextRandom(seed) | 1;
+  int32_t start_score = state.score;
+
+  rollout_result result;
+  int frame = 0;
+  for (; frame < search.horizon; frame++)
+  {
+    if (frame > 0 && frame % search.hold == 0)
+    {
+      action = BOT_ACTIONS[nextRandom(policy) % NUM_OF_BOT_ACTIONS];
+    }
+
+    simulate(layout, state, action, search.step_time);
+    result.steps++;
+    if (state.game_over || state.wave_cleared)
+    {
+      break;
+    }
+  }
+
+  float survival =
+    state.game_over
+      ? static_cast<float>(frame) / static_cast<float>(search.horizon)
+      : 1.0f;
+  result.value = survival * static_cast<float>(1 + state.score - start_score);
+  return result;
+}
+
+uint64_t MonteCarloPlayer::steps() const
+{
+  return total_steps;
+}
+
+double MonteCarloPlayer::stepsPerSecond() const
+{
+  double seconds = std::chrono::duration<double>(total_time).count();
+  return seconds > 0 ? static_cast<double>(total_steps) / seconds : 0;
+}
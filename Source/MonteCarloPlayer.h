@@ -0,0 +1,83 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Simulation.h"
+#include "Utility/WorkerPool.h"
+
+/**
+ *  How a MonteCarloPlayer searches for its next action.
+ */
+struct rollout_settings
+{
+  int rollouts = 32;           /**< Futures tried for each action. */
+  int horizon = 60;            /**< Frames each future lasts. */
+  int hold = 8;                /**< Frames each action is held for. */
+  float step_time = 1.0f / 60; /**< Seconds each simulated frame lasts. */
+};
+
+/**
+ *  A bot that plays by trying out futures.
+ *  For each action it could take, it forks the simulated game many times
+ *  and plays each copy out for a short while, holding the action first
+ *  and then pressing keys at random. Each action is scored by how long
+ *  its futures survived times the score they gained, on average, and
+ *  the best is played. The futures are independent, so they are shared
+ *  out across a WorkerPool, and each draws from its own generator seeded
+ *  by its number, so the choice is the same however many threads run.
+ */
+class MonteCarloPlayer
+{
+ public:
+  MonteCarloPlayer() = default;
+  ~MonteCarloPlayer() = default;
+
+  /**
+   *  Changes how the bot searches, allocating space for its results.
+   *  @param [in] new_settings The new settings
+   */
+  void settings(const rollout_settings& new_settings);
+
+  /**
+   *  Picks the action to play next.
+   *  @param [in] layout The wave being played
+   *  @param [in] state The game as it is now
+   *  @param [in] workers Threads to share the futures with (optional)
+   *  @return the ACTION_ bits to play
+   */
+  uint8_t choose(const sim_layout& layout,
+                 const sim_state& state,
+                 WorkerPool* workers = nullptr);
+
+  /**
+   *  The number of simulated frames stepped so far.
+   *  @return the frame count
+   */
+  uint64_t steps() const;
+
+  /**
+   *  How fast the futures have been simulated so far.
+   *  @return simulated frames per second of real time
+   */
+  double stepsPerSecond() const;
+
+ private:
+  struct rollout_result
+  {
+    float value = 0;
+    uint32_t steps = 0;
+  };
+
+  rollout_result rollout(const sim_layout& layout,
+                         sim_state state,
+                         uint8_t action,
+                         uint32_t seed) const;
+
+  rollout_settings search;
+  std::vector<rollout_result> results;
+  uint64_t decisions = 0;
+  uint64_t total_steps = 0;
+  std::chrono::nanoseconds total_time{ 0 };
+};
@@ -0,0 +1,314 @@
+#include "Simulation.h"
+
+#include <algorithm>
+
+#include "Utility/Hash.h"
+
+static rect bounds(float x, float y, float width, float height)
+{
+  rect area;
+  area.x = x;
+  area.y = y;
+  area.length = width;
+  area.height = height;
+  return area;
+}
+
+static rect shipBounds(const sim_layout& layout, const sim_state& state, int i)
+{
+  return bounds(state.formation.origin_x + layout.slot_xs[i],
+                state.formation.origin_y + layout.slot_ys[i],
+                layout.ship_width,
+                layout.ship_height);
+}
+
+/**
+ *   @brief   Picks the time until an enemy shot is next tried.
+ *   @return  A time between the layout's shortest and longest.
+ */
+static float fireDelay(const sim_layout& layout, uint32_t& seed)
+{
+  float blend = static_cast<float>(nextRandom(seed) >> 8) / 16777216.0f;
+  return layout.fire_min + (layout.fire_max - layout.fire_min) * blend;
+}
+
+/**
+ *   @brief   Fires the enemy shots whose timers have run out.
+ *   @details As in the game, each shot picks a random ship when its
+ *            timer runs out and only fires if the shot is free and the
+ *            ship is alive. Either way it waits a random time to try
+ *            again.
+ *   @return  void
+ */
+static void fireEnemyShots(const sim_layout& layout,
+                           sim_state& state,
+                           float delta_time)
+{
+  for (int i = 0; i < NUM_OF_SHOTS; i++)
+  {
+    state.fire_timers[i] -= delta_time;
+    if (state.fire_timers[i] > 0)
+    {
+      continue;
+    }
+
+    state.fire_timers[i] += fireDelay(layout, state.random);
+    if (layout.ship_count == 0)
+    {
+      continue;
+    }
+
+    auto ship_count = static_cast<uint32_t>(layout.ship_count);
+    int ship = static_cast<int>(nextRandom(state.random) % ship_count);
+    if (!state.enemy_shots[i] && state.ships[ship])
+    {
+      rect from = shipBounds(layout, state, ship);
+      state.enemy_shots[i] = true;
+      state.enemy_shot_xs[i] = from.x + from.length / 2;
+      state.enemy_shot_ys[i] = from.y + from.height + 5;
+    }
+  }
+}
+
+/**
+ *   @brief   Moves the player and everything in flight.
+ *   @details Objects only move while they are inside the play area, as
+ *            GameObjectController::moveObject does.
+ *   @return  void
+ */
+static void moveObjects(const sim_layout& layout,
+                        sim_state& state,
+                        uint8_t action,
+                        float delta_time)
+{
+  float step = layout.player_speed * delta_time;
+  if ((action & ACTION_LEFT) && state.player_x > 0)
+  {
+    state.player_x -= step;
+  }
+  else if ((action & ACTION_RIGHT) && !(action & ACTION_LEFT) &&
+           state.player_x < layout.width - layout.player_width)
+  {
+    state.player_x += step;
+  }
+
+  if (layout.formation)
+  {
+    advanceFormation(state.formation,
+                     layout.left_offset,
+                     layout.right_offset,
+                     layout.ship_width,
+                     layout.width,
+                     delta_time);
+  }
+
+  float shot_step = layout.shot_speed * delta_time;
+  for (int i = 0; i < NUM_OF_SHOTS; i++)
+  {
+    if (state.player_shots[i] && state.player_shot_ys[i] > 0)
+    {
+      state.player_shot_ys[i] -= shot_step;
+    }
+    if (state.enemy_shots[i] &&
+        state.enemy_shot_ys[i] < layout.height - layout.shot_height)
+    {
+      state.enemy_shot_ys[i] += shot_step;
+    }
+  }
+}
+
+/**
+ *   @brief   Checks the shots against the ships and the player.
+ *   @details A player shot is only checked against each ship if it is
+ *            inside the area around every ship, which most are not.
+ *   @return  void
+ */
+static void shotCollision(const sim_layout& layout, sim_state& state)
+{
+  const auto& origin = state.formation;
+  const rect& area = layout.ship_area;
+  rect block = bounds(origin.origin_x + area.x,
+                      origin.origin_y + area.y,
+                      area.length,
+                      area.height);
+
+  for (int i = 0; i < NUM_OF_SHOTS; i++)
+  {
+    rect shot = bounds(state.player_shot_xs[i],
+                       state.player_shot_ys[i],
+                       layout.shot_width,
+                       layout.shot_height);
+    for (int j = 0; j < layout.ship_count; j++)
+    {
+      if (!state.player_shots[i] || !block.isInside(shot))
+      {
+        break;
+      }
+
+      if (state.ships[j] &&
+          CollisionMask::touching(shot,
+                                  layout.player_shot_mask,
+                                  shipBounds(layout, state, j),
+                                  layout.ship_masks[j]))
+      {
+        state.ships[j] = false;
+        state.ships_left--;
+        state.player_shots[i] = false;
+        state.score += 5;
+      }
+    }
+
+    if (state.player_shot_ys[i] < 0)
+    {
+      state.player_shots[i] = false;
+    }
+  }
+
+  rect player = bounds(state.player_x,
+                       state.player_y,
+                       layout.player_width,
+                       layout.player_height);
+  for (int i = 0; i < NUM_OF_SHOTS; i++)
+  {
+    if (state.enemy_shot_ys[i] > layout.height - layout.shot_height)
+    {
+      state.enemy_shots[i] = false;
+    }
+
+    if (state.enemy_shots[i] &&
+        CollisionMask::touching(bounds(state.enemy_shot_xs[i],
+                                       state.enemy_shot_ys[i],
+                                       layout.shot_width,
+                                       layout.shot_height),
+                                layout.enemy_shot_mask,
+                                player,
+                                layout.player_mask))
+    {
+      state.game_over = true;
+    }
+  }
+}
+
+/**
+ *   @brief   Steps a simulated wave forward by one frame.
+ *   @details The action's shot is fired first, as the game fires from
+ *            its key handler before updating. Then, like the game's
+ *            update: timers, the end of the wave and the ships reaching
+ *            the player, movement and finally shots.
+ *   @return  void
+ */
+void simulate(const sim_layout& layout,
+              sim_state& state,
+              uint8_t action,
+              float delta_time)
+{
+  if (state.game_over || state.wave_cleared)
+  {
+    return;
+  }
+
+  if (action & ACTION_FIRE)
+  {
+    for (int i = 0; i < NUM_OF_SHOTS; i++)
+    {
+      if (!state.player_shots[i])
+      {
+        state.player_shots[i] = true;
+        state.player_shot_xs[i] = state.player_x + layout.player_width / 2;
+        state.player_shot_ys[i] = state.player_y - 10;
+        break;
+      }
+    }
+  }
+
+  fireEnemyShots(layout, state, delta_time);
+
+  state.wave_cleared = state.ships_left <= 0;
+  rect player = bounds(state.player_x,
+                       state.player_y,
+                       layout.player_width,
+                       layout.player_height);
+  for (int i = 0; i < layout.ship_count; i++)
+  {
+    if (state.ships[i] && CollisionMask::touching(shipBounds(layout, state, i),
+                                                  layout.ship_masks[i],
+                                                  player,
+                                                  layout.player_mask))
+    {
+      state.game_over = true;
+    }
+  }
+
+  moveObjects(layout, state, action, delta_time);
+  shotCollision(layout, state);
+}
+
+/**
+ *   @brief   Sets up a simulation of a wave from the start.
+ *   @details The player starts where the game puts it, with the
+ *            formation at its origin heading right at the wave's base
+ *            speed. Masks and the endless speed-up are left to the
+ *            caller.
+ *   @return  void
+ */
+void startWave(const wave_definition& wave,
+               float width,
+               float height,
+               sim_layout& layout,
+               sim_state& state)
+{
+  layout = sim_layout{};
+  layout.width = width;
+  layout.height = height;
+  layout.player_width = PLAYER_WIDTH;
+  layout.player_height = PLAYER_HEIGHT;
+  layout.player_speed = PLAYER_SPEED;
+  layout.shot_width = SHOT_WIDTH;
+  layout.shot_height = SHOT_HEIGHT;
+  layout.shot_speed = SHOT_SPEED;
+  layout.ship_width = wave.ship_width;
+  layout.ship_height = wave.ship_height;
+  layout.fire_min = ENEMY_FIRE_MIN;
+  layout.fire_max = ENEMY_FIRE_MAX;
+
+  state = sim_state{};
+  state.player_x = width / 2 - 50;
+  state.player_y = height - 100;
+  state.formation.speed = wave.speed;
+
+  layout.ship_count = std::min(static_cast<int>(wave.ships.size()), MAX_SHIPS);
+  float top = 0;
+  float bottom = 0;
+  for (int i = 0; i < layout.ship_count; i++)
+  {
+    const ship_prefab& ship = wave.ships[static_cast<size_t>(i)];
+    layout.slot_xs[i] = ship.x;
+    layout.slot_ys[i] = ship.y;
+    if (i == 0)
+    {
+      layout.left_offset = layout.right_offset = ship.x;
+      top = bottom = ship.y;
+    }
+    layout.left_offset = std::min(layout.left_offset, ship.x);
+    layout.right_offset = std::max(layout.right_offset, ship.x);
+    top = std::min(top, ship.y);
+    bottom = std::max(bottom, ship.y);
+    state.ships[i] = true;
+  }
+  layout.ship_area = bounds(layout.left_offset,
+                            top,
+                            layout.right_offset - layout.left_offset +
+                              layout.ship_width,
+                            bottom - top + layout.ship_height);
+  state.ships_left = layout.ship_count;
+  seedSimulation(layout, state, 0);
+}
+
+void seedSimulation(const sim_layout& layout, sim_state& state, uint64_t seed)
+{
+  state.random = static_cast<uint32_t>(hashBytes(&seed, sizeof(seed))) | 1;
+  for (int i = 0; i < NUM_OF_SHOTS; i++)
+  {
+    state.fire_timers[i] = fireDelay(layout, state.random);
+  }
+}
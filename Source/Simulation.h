@@ -0,0 +1,146 @@
+#pragma once
+#include <cstdint>
+
+#include "Components/Formation.h"
+#include "GameState.h"
+#include "Utility/CollisionMask.h"
+#include "Utility/Wave.h"
+
+// the parts of an action, which can be combined
+const uint8_t ACTION_LEFT = 1;
+const uint8_t ACTION_RIGHT = 2;
+const uint8_t ACTION_FIRE = 4;
+
+// how the player and shots are set up, in the game and when simulated
+const float PLAYER_WIDTH = 99;
+const float PLAYER_HEIGHT = 75;
+const float PLAYER_SPEED = 200;
+const float SHOT_WIDTH = 10;
+const float SHOT_HEIGHT = 20;
+const float SHOT_SPEED = 200;
+const float ENEMY_FIRE_MIN = 3;
+const float ENEMY_FIRE_MAX = 10;
+// a fire timer for a shot with no timer running, which never runs out
+const float NO_FIRE_TIMER = 1e9f;
+
+/**
+ *  The parts of a wave that do not change while it is played.
+ *  Shared, read only, by every copy of a simulation of the wave.
+ */
+struct sim_layout
+{
+  float width = 0;
+  float height = 0;
+  float player_width = 0;
+  float player_height = 0;
+  float player_speed = 0;
+  float shot_width = 0;
+  float shot_height = 0;
+  float shot_speed = 0;
+  float ship_width = 0;
+  float ship_height = 0;
+  float fire_min = 0; /**< The shortest time between enemy shots. */
+  float fire_max = 0; /**< The longest time between enemy shots. */
+  bool formation = true; /**< Whether the ships move as one block. */
+
+  int ship_count = 0;
+  float slot_xs[MAX_SHIPS] = {}; /**< Offsets from the formation. */
+  float slot_ys[MAX_SHIPS] = {};
+  float left_offset = 0; /**< The outermost slots' offsets, for turning. */
+  float right_offset = 0;
+  rect ship_area; /**< Around every ship, from the formation's origin. */
+
+  const CollisionMask* player_mask = nullptr;
+  const CollisionMask* player_shot_mask = nullptr;
+  const CollisionMask* enemy_shot_mask = nullptr;
+  const CollisionMask* ship_masks[MAX_SHIPS] = {};
+};
+
+/**
+ *  A wave being played, without sprites, particles or a renderer.
+ *  A few hundred bytes of plain data, so a copy is a cheap way to fork
+ *  the game and try out a future without touching the real one. Ships
+ *  are in a formation, as in the normal mode. Dives, bullet hell bullets
+ *  and the swarm are not simulated.
+ */
+struct sim_state
+{
+  float player_x = 0;
+  float player_y = 0;
+  formation_snapshot formation;
+  bool ships[MAX_SHIPS] = {}; /**< Whether each ship is alive. */
+  int ships_left = 0;
+
+  bool player_shots[NUM_OF_SHOTS] = {};
+  float player_shot_xs[NUM_OF_SHOTS] = {};
+  float player_shot_ys[NUM_OF_SHOTS] = {};
+  bool enemy_shots[NUM_OF_SHOTS] = {};
+  float enemy_shot_xs[NUM_OF_SHOTS] = {};
+  float enemy_shot_ys[NUM_OF_SHOTS] = {};
+  float fire_timers[NUM_OF_SHOTS] = {}; /**< Seconds to each enemy shot. */
+
+  uint32_t random = 1;
+  int32_t score = 0;
+  bool game_over = false;
+  bool wave_cleared = false;
+};
+
+/**
+ *  Steps a simulated wave forward by one frame.
+ *  Follows the same rules, in the same order, as the game's own update,
+ *  with the action standing in for the keys held during the frame.
+ *  @param [in] layout The wave being played
+ *  @param [in,out] state The state to step
+ *  @param [in] action The ACTION_ bits to play
+ *  @param [in] delta_time The time passed in seconds
+ */
+void simulate(const sim_layout& layout,
+              sim_state& state,
+              uint8_t action,
+              float delta_time);
+
+/**
+ *  Sets up a simulation of a wave from the start.
+ *  The player, ships and formation are placed as the game places them,
+ *  but a few things differ from the game:
+ *  - the formation moves at the wave's own speed, without the speed-up
+ *    of later loops in endless mode; set state.formation.speed for that
+ *  - the layout has no collision masks, so everything is checked by its
+ *    bounding box until masks are put in the layout
+ *  - the enemy shots' timers start straight away, without the
+ *    WAVE_DELAY the game waits between waves
+ *  @param [in] wave The wave to play
+ *  @param [in] width The width of the play area
+ *  @param [in] height The height of the play area
+ *  @param [out] layout The wave's layout
+ *  @param [out] state The state at the start of the wave
+ */
+void startWave(const wave_definition& wave,
+               float width,
+               float height,
+               sim_layout& layout,
+               sim_state& state);
+
+/**
+ *  Gives a simulation its own random numbers.
+ *  The enemy shots' timers are drawn again from the new generator, so
+ *  simulations started from the same state soon play out differently.
+ *  @param [in] layout The wave being played
+ *  @param [in,out] state The state to seed
+ *  @param [in] seed The seed, which may be any value
+ */
+void seedSimulation(const sim_layout& layout, sim_state& state, uint64_t seed);
+
+/**
+ *  Draws the next number from a xorshift generator.
+ *  Small and fast enough to give every simulation its own generator.
+ *  @param [in,out] seed The generator's state, never zero
+ *  @return the next number
+ */
+inline uint32_t nextRandom(uint32_t& seed)
+{
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  return seed;
+}
@@ -0,0 +1,339 @@
+#include "AllocationTracker.h"
+
+#ifdef TRACK_ALLOCATIONS
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <vector>
+
+const int MAX_ZONES = 8;
+const int MAX_ZONE_DEPTH = 16;
+const size_t MAX_SITES = 1024;
+const size_t MAX_FRAME_RECORDS = 60 * 60 * 10;
+
+struct zone_stats
+{
+  const char* name = nullptr;
+  allocation_stats stats;
+};
+
+struct call_site
+{
+  const void* address = nullptr;
+  size_t allocations = 0;
+  size_t bytes = 0;
+};
+
+struct frame_record
+{
+  double frame_ms = 0;
+  allocation_stats stats;
+  allocation_stats zones[MAX_ZONES];
+};
+
+/**
+ *  Everything is tracked per thread in fixed size storage, as nothing
+ *  may allocate while recording an allocation. suspended is set while
+ *  the tracker itself allocates, or reports, so it does not count
+ *  itself.
+ */
+static thread_local bool suspended = false;
+static thread_local bool forbidden = false;
+static thread_local allocation_stats frame_stats;
+static thread_local zone_stats zones[MAX_ZONES];
+static thread_local const char* zone_stack[MAX_ZONE_DEPTH];
+static thread_local int zone_depth = 0;
+static thread_local call_site sites[MAX_SITES];
+
+// frames are only recorded by the thread calling endFrame, and only
+// the most recent are kept so long sessions use a fixed amount of memory
+static std::mutex frames_mutex;
+static std::vector<frame_record> frames;
+static size_t frame_count = 0;
+static const char* frame_zone_names[MAX_ZONES];
+
+static allocation_stats* currentZone()
+{
+  if (zone_depth == 0 || zone_depth > MAX_ZONE_DEPTH)
+  {
+    return nullptr;
+  }
+
+  const char* name = zone_stack[zone_depth - 1];
+  for (auto& zone : zones)
+  {
+    if (zone.name == name || zone.name == nullptr)
+    {
+      zone.name = name;
+      return &zone.stats;
+    }
+  }
+  return nullptr;
+}
+
+/**
+ *   @brief   Counts an allocation against its call site.
+ *   @details Sites are kept in an open addressed table keyed on the
+ *            return address. Once the table is full, new sites are no
+ *            longer recorded individually but still count towards the
+ *            frame and zone totals.
+ *   @return  void
+ */
+static void recordSite(const void* address, size_t size)
+{
+  auto hash = reinterpret_cast<uintptr_t>(address) >> 2;
+  for (size_t probe = 0; probe < MAX_SITES; probe++)
+  {
+    call_site& site = sites[(hash + probe) % MAX_SITES];
+    if (site.address == address || site.address == nullptr)
+    {
+      site.address = address;
+      site.allocations++;
+      site.bytes += size;
+      return;
+    }
+  }
+}
+
+static void recordAllocation(size_t size, const void* address)
+{
+  if (suspended)
+  {
+    return;
+  }
+
+  frame_stats.allocations++;
+  frame_stats.bytes += size;
+  if (allocation_stats* zone = currentZone())
+  {
+    zone->allocations++;
+    zone->bytes += size;
+  }
+  recordSite(address, size);
+
+  if (forbidden)
+  {
+    suspended = true;
+    std::fprintf(stderr,
+                 "heap allocation of %zu bytes from %p in a no allocation "
+                 "scope\n",
+                 size,
+                 address);
+    suspended = false;
+    assert(!"heap allocation in a no allocation scope");
+  }
+}
+
+static void recordFree()
+{
+  if (suspended)
+  {
+    return;
+  }
+
+  frame_stats.frees++;
+  if (allocation_stats* zone = currentZone())
+  {
+    zone->frees++;
+  }
+}
+
+static void* allocate(size_t size, const void* address)
+{
+  void* memory = std::malloc(size ? size : 1);
+  if (memory)
+  {
+    recordAllocation(size, address);
+  }
+  return memory;
+}
+
+static void deallocate(void* memory)
+{
+  if (memory)
+  {
+    recordFree();
+    std::free(memory);
+  }
+}
+
+#if defined(__GNUC__)
+#define CALL_SITE __builtin_return_address(0)
+#else
+#define CALL_SITE nullptr
+#endif
+
+void* operator new(size_t size)
+{
+  void* memory = allocate(size, CALL_SITE);
+  if (!memory)
+  {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void* operator new[](size_t size)
+{
+  void* memory = allocate(size, CALL_SITE);
+  if (!memory)
+  {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+  return allocate(size, CALL_SITE);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+  return allocate(size, CALL_SITE);
+}
+
+void operator delete(void* memory) noexcept
+{
+  deallocate(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+  deallocate(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+  deallocate(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+  deallocate(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+  deallocate(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+  deallocate(memory);
+}
+
+allocation_stats AllocationTracker::frame()
+{
+  return frame_stats;
+}
+
+/**
+ *   @brief   Stores the thread's frame and clears its counters.
+ *   @details Zones are stored in the order they were first seen, with
+ *            their names kept alongside for the report.
+ *   @return  void
+ */
+void AllocationTracker::endFrame(double frame_ms)
+{
+  suspended = true;
+  {
+    frame_record record;
+    record.frame_ms = frame_ms;
+    record.stats = frame_stats;
+
+    std::lock_guard<std::mutex> lock(frames_mutex);
+    for (int i = 0; i < MAX_ZONES && zones[i].name; i++)
+    {
+      frame_zone_names[i] = zones[i].name;
+      record.zones[i] = zones[i].stats;
+      zones[i].stats = allocation_stats();
+    }
+    if (frames.size() < MAX_FRAME_RECORDS)
+    {
+      frames.push_back(record);
+    }
+    else
+    {
+      frames[frame_count % MAX_FRAME_RECORDS] = record;
+    }
+    frame_count++;
+  }
+  frame_stats = allocation_stats();
+  suspended = false;
+}
+
+void AllocationTracker::writeReport(const std::string& prefix)
+{
+  suspended = true;
+  {
+    std::lock_guard<std::mutex> lock(frames_mutex);
+    std::ofstream frames_csv(prefix + "_frames.csv");
+    frames_csv << "frame,frame_ms,allocations,frees,bytes";
+    for (int i = 0; i < MAX_ZONES && frame_zone_names[i]; i++)
+    {
+      frames_csv << "," << frame_zone_names[i] << "_allocations,"
+                 << frame_zone_names[i] << "_bytes";
+    }
+    frames_csv << "\n";
+
+    for (size_t frame = frame_count - frames.size(); frame < frame_count;
+         frame++)
+    {
+      const frame_record& record = frames[frame % MAX_FRAME_RECORDS];
+      frames_csv << frame << "," << record.frame_ms << ","
+                 << record.stats.allocations << "," << record.stats.frees
+                 << "," << record.stats.bytes;
+      for (int i = 0; i < MAX_ZONES && frame_zone_names[i]; i++)
+      {
+        frames_csv << "," << record.zones[i].allocations << ","
+                   << record.zones[i].bytes;
+      }
+      frames_csv << "\n";
+    }
+  }
+
+  std::ofstream sites_csv(prefix + "_sites.csv");
+  sites_csv << "address,allocations,bytes\n";
+  for (const auto& site : sites)
+  {
+    if (site.address)
+    {
+      sites_csv << site.address << "," << site.allocations << ","
+                << site.bytes << "\n";
+    }
+  }
+  suspended = false;
+}
+
+AllocationZone::AllocationZone(const char* name)
+{
+  if (zone_depth < MAX_ZONE_DEPTH)
+  {
+    zone_stack[zone_depth] = name;
+  }
+  zone_depth++;
+}
+
+AllocationZone::~AllocationZone()
+{
+  zone_depth--;
+}
+
+NoAllocationScope::NoAllocationScope(bool active) : was_active(forbidden)
+{
+  forbidden = was_active || active;
+}
+
+NoAllocationScope::~NoAllocationScope()
+{
+  forbidden = was_active;
+}
+
+#endif
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+/**
+ *  Heap allocation statistics for one thread.
+ */
+struct allocation_stats
+{
+  size_t allocations = 0;
+  size_t frees = 0;
+  size_t bytes = 0;
+};
+
+#ifdef TRACK_ALLOCATIONS
+
+/**
+ *  Counts heap allocations made through the global operator new.
+ *  Only built when the TRACK_ALLOCATIONS CMake option is on, which
+ *  replaces operator new and delete for the whole program. Each thread
+ *  counts its own allocations, grouped by frame, by the innermost
+ *  AllocationZone and by call site.
+ *  @see AllocationZone
+ *  @see NoAllocationScope
+ */
+class AllocationTracker
+{
+ public:
+  /**
+   *  The calling thread's allocations since its last endFrame().
+   *  @return the frame's statistics so far
+   */
+  static allocation_stats frame();
+
+  /**
+   *  Records the calling thread's frame and starts the next.
+   *  @param [in] frame_ms How long the frame took
+   */
+  static void endFrame(double frame_ms);
+
+  /**
+   *  Writes the recorded frames and call sites as CSV.
+   *  Frames, with their time and the allocations in each zone, are
+   *  written to <prefix>_frames.csv. Call sites, as addresses that can be
+   *  resolved with addr2line, are written to <prefix>_sites.csv.
+   *  @param [in] prefix The path to write the files to
+   */
+  static void writeReport(const std::string& prefix);
+};
+
+/**
+ *  Attributes the allocations made in a scope to a named zone.
+ *  Zones nest, and allocations count towards the innermost zone only.
+ */
+class AllocationZone
+{
+ public:
+  /**
+   *  @param [in] name The zone's name, which must be a string literal
+   */
+  explicit AllocationZone(const char* name);
+  ~AllocationZone();
+  AllocationZone(const AllocationZone&) = delete;
+  AllocationZone& operator=(const AllocationZone&) = delete;
+};
+
+/**
+ *  Flags any heap allocation made on this thread within a scope.
+ *  Each allocation is reported with its size and call site, and debug
+ *  builds then fail an assertion.
+ */
+class NoAllocationScope
+{
+ public:
+  /**
+   *  @param [in] active Whether allocations are forbidden in this scope
+   */
+  explicit NoAllocationScope(bool active);
+  ~NoAllocationScope();
+  NoAllocationScope(const NoAllocationScope&) = delete;
+  NoAllocationScope& operator=(const NoAllocationScope&) = delete;
+
+ private:
+  bool was_active = false;
+};
+
+#else
+
+// without TRACK_ALLOCATIONS the tracker compiles away to nothing
+class AllocationTracker
+{
+ public:
+  static allocation_stats frame() { return allocation_stats(); }
+  static void endFrame(double) {}
+  static void writeReport(const std::string&) {}
+};
+
+class AllocationZone
+{
+ public:
+  explicit AllocationZone(const char*) {}
+};
+
+class NoAllocationScope
+{
+ public:
+  explicit NoAllocationScope(bool) {}
+};
+
+#endif
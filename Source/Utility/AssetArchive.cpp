@@ -0,0 +1,218 @@
+#include "AssetArchive.h"
+#include "Hash.h"
+#include <cstring>
+
+#if defined(_WIN32)
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+AssetArchive::~AssetArchive()
+{
+  close();
+}
+
+/**
+ *   @brief   Maps the archive.
+ *   @details The file is mapped read only in its entirety. The header
+ *            and index are validated before any lookups are allowed.
+ *   @return  True if the archive was mapped and is valid.
+ */
+bool AssetArchive::open(const std::string& file_path)
+{
+  close();
+
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(file_path.c_str(),
+                            GENERIC_READ,
+                            FILE_SHARE_READ,
+                            nullptr,
+                            OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+
+  LARGE_INTEGER file_size;
+  HANDLE mapping = nullptr;
+  if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
+  {
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  }
+
+  if (!mapping)
+  {
+    CloseHandle(file);
+    return false;
+  }
+
+  file_handle = file;
+  mapping_handle = mapping;
+  base = static_cast<const unsigned char*>(
+    MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+  length = static_cast<size_t>(file_size.QuadPart);
+#else
+  int fd = ::open(file_path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    return false;
+  }
+
+  struct stat file_stat = {};
+  void* mapping = MAP_FAILED;
+  if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0)
+  {
+    mapping = mmap(nullptr,
+                   static_cast<size_t>(file_stat.st_size),
+                   PROT_READ,
+                   MAP_PRIVATE,
+                   fd,
+                   0);
+  }
+
+  // the mapping keeps the file alive, the descriptor is no longer needed
+  ::close(fd);
+  if (mapping == MAP_FAILED)
+  {
+    return false;
+  }
+
+  base = static_cast<const unsigned char*>(mapping);
+  length = static_cast<size_t>(file_stat.st_size);
+#endif
+
+  if (!base || !validate())
+  {
+    close();
+    return false;
+  }
+
+  ArchiveHeader header;
+  std::memcpy(&header, base, sizeof(header));
+  entry_count = header.entry_count;
+  entries = reinterpret_cast<const ArchiveEntry*>(base + sizeof(header));
+  return true;
+}
+
+void AssetArchive::close()
+{
+#if defined(_WIN32)
+  if (base)
+  {
+    UnmapViewOfFile(base);
+  }
+  if (mapping_handle)
+  {
+    CloseHandle(mapping_handle);
+  }
+  if (file_handle)
+  {
+    CloseHandle(file_handle);
+  }
+  mapping_handle = nullptr;
+  file_handle = nullptr;
+#else
+  if (base)
+  {
+    munmap(const_cast<unsigned char*>(base), length);
+  }
+#endif
+
+  base = nullptr;
+  length = 0;
+  entries = nullptr;
+  entry_count = 0;
+}
+
+bool AssetArchive::isOpen() const
+{
+  return base != nullptr;
+}
+
+/**
+ *   @brief   Finds a file in the archive.
+ *   @details Binary searches the sorted index for the path's hash. The
+ *            returned view points directly into the mapped archive.
+ *   @return  The file's view, or an empty view if not present.
+ */
+AssetArchive::View AssetArchive::find(const std::string& path) const
+{
+  View view;
+  if (!entries)
+  {
+    return view;
+  }
+
+  uint64_t hash = hashPath(path);
+  uint32_t low = 0;
+  uint32_t high = entry_count;
+  while (low < high)
+  {
+    uint32_t mid = low + (high - low) / 2;
+    if (entries[mid].path_hash < hash)
+    {
+      low = mid + 1;
+    }
+    else
+    {
+      high = mid;
+    }
+  }
+
+  if (low < entry_count && entries[low].path_hash == hash)
+  {
+    view.data = base + entries[low].offset;
+    view.size = static_cast<size_t>(entries[low].size);
+    view.hash = entries[low].content_hash;
+  }
+  return view;
+}
+
+/**
+ *   @brief   Checks the archive is safe to read.
+ *   @details Verifies the magic, version and that every entry lies
+ *            within the mapped file and is correctly aligned.
+ *   @return  True if the archive is valid.
+ */
+bool AssetArchive::validate() const
+{
+  if (length < sizeof(ArchiveHeader))
+  {
+    return false;
+  }
+
+  ArchiveHeader header;
+  std::memcpy(&header, base, sizeof(header));
+  if (std::memcmp(header.magic, ARCHIVE_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != ARCHIVE_VERSION)
+  {
+    return false;
+  }
+
+  uint64_t index_end =
+    sizeof(ArchiveHeader) +
+    static_cast<uint64_t>(header.entry_count) * sizeof(ArchiveEntry);
+  if (index_end > length)
+  {
+    return false;
+  }
+
+  auto index = reinterpret_cast<const ArchiveEntry*>(base + sizeof(header));
+  for (uint32_t i = 0; i < header.entry_count; i++)
+  {
+    const ArchiveEntry& entry = index[i];
+    if (entry.offset % ARCHIVE_ALIGNMENT != 0 || entry.offset < index_end ||
+        entry.offset > length || entry.size > length - entry.offset)
+    {
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+const char ARCHIVE_MAGIC[4] = { 'S', 'I', 'P', 'K' };
+const uint32_t ARCHIVE_VERSION = 2;
+const uint64_t ARCHIVE_ALIGNMENT = 16;
+
+/**
+ *  The header at the start of every packed archive.
+ *  It is immediately followed by entry_count ArchiveEntry records,
+ *  sorted by path hash so they can be binary searched in place.
+ */
+struct ArchiveHeader
+{
+  char magic[4] = { 0, 0, 0, 0 };
+  uint32_t version = 0;
+  uint32_t entry_count = 0;
+  uint32_t reserved = 0;
+};
+
+/**
+ *  Locates a single file inside a packed archive.
+ *  The offset is from the start of the archive and is always a multiple
+ *  of ARCHIVE_ALIGNMENT. The contents are hashed when packed, so a file
+ *  can be recognised without reading it.
+ */
+struct ArchiveEntry
+{
+  uint64_t path_hash = 0;
+  uint64_t offset = 0;
+  uint64_t size = 0;
+  uint64_t content_hash = 0;
+};
+
+static_assert(sizeof(ArchiveHeader) == 16, "archive header must be packed");
+static_assert(sizeof(ArchiveEntry) == 32, "archive entry must be packed");
+
+/**
+ *  A read only, memory mapped view of the packed GameData archive.
+ *  The whole archive is mapped with a single open call and files are
+ *  returned as pointers straight into the mapping, so reading an asset
+ *  never copies or allocates.
+ *  @see Tools/AssetPacker
+ */
+class AssetArchive
+{
+ public:
+  /**
+   *  A file inside the archive. Only valid while the archive is open.
+   */
+  struct View
+  {
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    uint64_t hash = 0; /**< The hash of the contents, from the index. */
+  };
+
+  AssetArchive() = default;
+
+  /**
+   *  Destructor. Unmaps the archive.
+   */
+  ~AssetArchive();
+
+  AssetArchive(const AssetArchive&) = delete;
+  AssetArchive& operator=(const AssetArchive&) = delete;
+
+  /**
+   *  Maps an archive into memory and validates its index.
+   *  @param [in] file_path The path to the archive on disk
+   *  @return true if the archive is mapped and usable
+   */
+  bool open(const std::string& file_path);
+
+  /**
+   *  Unmaps the archive. Any views handed out become invalid.
+   */
+  void close();
+
+  bool isOpen() const;
+
+  /**
+   *  Looks up a file by its path relative to GameData.
+   *  @param [in] path The path to find, i.e. "images/enemyRed1.png"
+   *  @return a view of the file, with a null data pointer if not found
+   */
+  View find(const std::string& path) const;
+
+ private:
+  bool validate() const;
+
+  const unsigned char* base = nullptr;
+  size_t length = 0;
+  const ArchiveEntry* entries = nullptr;
+  uint32_t entry_count = 0;
+
+#if defined(_WIN32)
+  void* file_handle = nullptr;
+  void* mapping_handle = nullptr;
+#endif
+};
@@ -0,0 +1,52 @@
+#include "AssetData.h"
+#include "Hash.h"
+
+/**
+ *   @brief   Loads a file from the archive or from GameData.
+ *   @details Archive reads are zero copy; files that are not packed are
+ *            read into this object's buffer.
+ *   @return  True if there is data to read.
+ */
+bool AssetData::load(const AssetArchive* archive, const std::string& path)
+{
+  view = AssetArchive::View();
+  buffer.clear();
+  packed = false;
+
+  if (archive)
+  {
+    view = archive->find(path);
+    if (view.data)
+    {
+      packed = true;
+      return view.size > 0;
+    }
+  }
+
+  ASGE::FILEIO::File file;
+  if (!file.open(path))
+  {
+    return false;
+  }
+
+  buffer = file.read();
+  file.close();
+  view.data = buffer.as_unsigned_char();
+  view.size = buffer.length;
+  return view.data && view.size > 0;
+}
+
+const unsigned char* AssetData::data() const
+{
+  return view.data;
+}
+
+size_t AssetData::size() const
+{
+  return view.size;
+}
+
+uint64_t AssetData::hash() const
+{
+  return packed ? view.hash : hashBytes(view.data, view.size);
+}
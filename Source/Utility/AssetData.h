@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <Engine/FileIO.h>
+
+#include "AssetArchive.h"
+
+/**
+ *  The contents of a single game data file.
+ *  Files are read straight out of the packed archive when it contains
+ *  them, otherwise they are read into memory through ASGE's FileIO.
+ *  Either way the bytes stay valid for the lifetime of this object.
+ */
+class AssetData
+{
+ public:
+  AssetData() = default;
+  ~AssetData() = default;
+
+  /**
+   *  Loads a file.
+   *  @param [in] archive The packed archive to check first (optional)
+   *  @param [in] path The path relative to GameData
+   *  @return true if the file was found and is not empty
+   */
+  bool load(const AssetArchive* archive, const std::string& path);
+
+  const unsigned char* data() const;
+  size_t size() const;
+
+  /**
+   *  Hashes the file's contents.
+   *  Packed files were hashed when the archive was built, so only files
+   *  read from GameData are hashed here.
+   *  @return the 64 bit hash of the contents
+   */
+  uint64_t hash() const;
+
+ private:
+  AssetArchive::View view;
+  ASGE::FILEIO::IOBuffer buffer;
+  bool packed = false;
+};
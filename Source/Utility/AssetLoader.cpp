@@ -0,0 +1,181 @@
+#include "AssetLoader.h"
+#include "AssetArchive.h"
+#include <algorithm>
+
+#include <Engine/FileIO.h>
+
+/**
+ *   @brief   Destructor.
+ *   @details Makes sure the prefetch worker is not left running.
+ */
+AssetLoader::~AssetLoader()
+{
+  stop();
+}
+
+/**
+ *   @brief   Adds a job to the load queue.
+ *   @details Jobs must be queued while the prefetch worker is stopped,
+ *            which it is before start() and once every job has run. A
+ *            finished batch is cleared first, keeping its capacity, so a
+ *            loader reused for many batches does not keep growing.
+ *   @return  void
+ */
+void AssetLoader::queue(const std::string& file_name, UploadFnc upload)
+{
+  if (finished() && next_job > 0)
+  {
+    jobs.clear();
+    next_job = 0;
+  }
+  jobs.push_back(Job{ file_name, std::move(upload) });
+}
+
+void AssetLoader::useArchive(const AssetArchive* asset_archive)
+{
+  archive = asset_archive;
+}
+
+/**
+ *   @brief   Starts the prefetch worker.
+ *   @details The worker walks the queue in order, reading each unique
+ *            file once so that it is resident before it is uploaded.
+ *   @return  void
+ */
+void AssetLoader::start()
+{
+  stop();
+  stopping = false;
+  worker = std::thread(&AssetLoader::prefetch, this);
+}
+
+/**
+ *   @brief   Runs jobs on the calling (render) thread.
+ *   @details Keeps running jobs until the budget is exhausted or the
+ *            queue is empty. A failed job stops loading altogether.
+ *   @return  False if a job failed.
+ */
+bool AssetLoader::process(std::chrono::microseconds budget)
+{
+  using clock = std::chrono::steady_clock;
+  auto start_time = clock::now();
+  auto elapsed = std::chrono::microseconds(0);
+
+  do
+  {
+    if (finished())
+    {
+      break;
+    }
+
+    bool loaded = jobs[next_job].upload();
+    next_job++;
+
+    elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      clock::now() - start_time);
+
+    if (!loaded)
+    {
+      upload_time += elapsed;
+      return false;
+    }
+  } while (elapsed < budget);
+
+  upload_time += elapsed;
+  if (finished())
+  {
+    stop();
+  }
+  return true;
+}
+
+bool AssetLoader::finished() const
+{
+  return next_job >= jobs.size();
+}
+
+float AssetLoader::progress() const
+{
+  if (jobs.empty())
+  {
+    return 1.0f;
+  }
+  return static_cast<float>(next_job) / static_cast<float>(jobs.size());
+}
+
+std::chrono::microseconds AssetLoader::uploadTime() const
+{
+  return upload_time;
+}
+
+/**
+ *   @brief   Reads queued files ahead of the render thread.
+ *   @details Runs on the worker thread. Files shared by several jobs,
+ *            such as the enemy textures, are only read once.
+ *   @return  void
+ */
+void AssetLoader::prefetch()
+{
+  std::vector<std::string> read_files;
+  for (const auto& job : jobs)
+  {
+    if (stopping)
+    {
+      return;
+    }
+
+    if (std::find(read_files.begin(), read_files.end(), job.file_name) !=
+        read_files.end())
+    {
+      continue;
+    }
+
+    if (!prefetchFromArchive(job.file_name))
+    {
+      ASGE::FILEIO::File file;
+      if (file.open(job.file_name))
+      {
+        file.read();
+        file.close();
+      }
+    }
+    read_files.push_back(job.file_name);
+  }
+}
+
+/**
+ *   @brief   Faults in a file's pages from the mapped archive.
+ *   @details Touches one byte per page, which is enough for the OS to
+ *            read the file in without copying it anywhere.
+ *   @return  False if there is no archive or the file is not in it.
+ */
+bool AssetLoader::prefetchFromArchive(const std::string& file_name) const
+{
+  if (!archive)
+  {
+    return false;
+  }
+
+  auto view = archive->find(file_name);
+  if (!view.data)
+  {
+    return false;
+  }
+
+  const size_t page_size = 4096;
+  volatile unsigned char touched = 0;
+  for (size_t i = 0; i < view.size; i += page_size)
+  {
+    touched = touched ^ view.data[i];
+  }
+  return true;
+}
+
+void AssetLoader::stop()
+{
+  stopping = true;
+  if (worker.joinable())
+  {
+    worker.join();
+  }
+}
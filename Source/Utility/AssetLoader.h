@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+class AssetArchive;
+
+/**
+ *  Streams game assets in behind the first frames.
+ *  Jobs are queued up front and a worker thread reads each file ahead of
+ *  the render thread so the OS has it cached by the time it is needed.
+ *  When a packed archive is available the worker instead faults in the
+ *  file's pages of the mapping, avoiding any per file lookups.
+ *  The texture upload itself must happen on the thread that owns the GL
+ *  context, so jobs are executed in small time slices by process(),
+ *  which the game calls once per frame until loading has finished.
+ */
+class AssetLoader
+{
+ public:
+  /**
+   *  A job that creates GPU resources. Must run on the render thread.
+   *  @return true if the asset was successfully loaded
+   */
+  using UploadFnc = std::function<bool()>;
+
+  AssetLoader() = default;
+
+  /**
+   *  Destructor. Stops and joins the prefetch worker.
+   */
+  ~AssetLoader();
+
+  AssetLoader(const AssetLoader&) = delete;
+  AssetLoader& operator=(const AssetLoader&) = delete;
+
+  /**
+   *  Queues an asset to be loaded.
+   *  Jobs are executed in the order they are queued, so anything needed
+   *  to draw the first gameplay frame should be queued first. Jobs can
+   *  be queued before the loader is started, or again once every job has
+   *  run, which starts a new batch in the same storage.
+   *  @param [in] file_name The file the job reads, used for prefetching
+   *  @param [in] upload The job to run on the render thread
+   */
+  void queue(const std::string& file_name, UploadFnc upload);
+
+  /**
+   *  Prefetches from a packed archive rather than individual files.
+   *  Files missing from the archive are still read from GameData.
+   *  @param [in] asset_archive The archive, must outlive the loader
+   */
+  void useArchive(const AssetArchive* asset_archive);
+
+  /**
+   *  Starts the prefetch worker. Call once all jobs are queued.
+   */
+  void start();
+
+  /**
+   *  Runs queued jobs until the time budget has been spent.
+   *  At least one job is always run so loading makes progress even
+   *  on slow frames.
+   *  @param [in] budget The time this frame may spend loading
+   *  @return false if a job failed, true otherwise
+   */
+  bool process(std::chrono::microseconds budget);
+
+  /**
+   *  Has every queued job been run?
+   *  @return true if there is nothing left to load
+   */
+  bool finished() const;
+
+  /**
+   *  How far through the queue the loader is.
+   *  @return a value between 0 and 1
+   */
+  float progress() const;
+
+  /**
+   *  Total time spent running jobs on the render thread.
+   *  @return the accumulated upload time
+   */
+  std::chrono::microseconds uploadTime() const;
+
+ private:
+  struct Job
+  {
+    std::string file_name;
+    UploadFnc upload;
+  };
+
+  void prefetch();
+  bool prefetchFromArchive(const std::string& file_name) const;
+  void stop();
+
+  std::vector<Job> jobs;
+  size_t next_job = 0;
+  std::chrono::microseconds upload_time{ 0 };
+  const AssetArchive* archive = nullptr;
+
+  std::thread worker;
+  std::atomic<bool> stopping{ false };
+};
@@ -0,0 +1,174 @@
+#include "CollisionMask.h"
+
+#include <algorithm>
+#include <cmath>
+
+const int WORD_BITS = 64;
+
+void CollisionMask::fromAlpha(const unsigned char* rgba,
+                              int width,
+                              int height,
+                              int threshold)
+{
+  resize(width, height);
+  for (int y = 0; y < height; y++)
+  {
+    for (int x = 0; x < width; x++)
+    {
+      if (rgba[(y * width + x) * 4 + 3] >= threshold)
+      {
+        rows[y * row_words + x / WORD_BITS] |= 1ull << (x % WORD_BITS);
+      }
+    }
+  }
+}
+
+void CollisionMask::fromWords(const uint64_t* words, int width, int height)
+{
+  resize(width, height);
+  std::copy(words, words + rows.size(), rows.begin());
+}
+
+/**
+ *   @brief   Resamples the mask.
+ *   @details Each new pixel takes the value of the source pixel under
+ *            its centre.
+ *   @return  The resampled mask.
+ */
+CollisionMask CollisionMask::scaled(int width, int height) const
+{
+  CollisionMask mask;
+  mask.resize(width, height);
+  for (int y = 0; y < height; y++)
+  {
+    int source_y = (2 * y + 1) * mask_height / (2 * height);
+    for (int x = 0; x < width; x++)
+    {
+      int source_x = (2 * x + 1) * mask_width / (2 * width);
+      if (solid(source_x, source_y))
+      {
+        mask.rows[y * mask.row_words + x / WORD_BITS] |= 1ull
+                                                         << (x % WORD_BITS);
+      }
+    }
+  }
+  return mask;
+}
+
+/**
+ *   @brief   Tests two masks for overlapping solid pixels.
+ *   @details Only the rows and words where the masks overlap are
+ *            visited. For each of this mask's words, the 64 pixels of
+ *            the other mask in the same place are gathered with two
+ *            shifts and ANDed with it, so a 50 pixel wide pair costs a
+ *            few word operations per row.
+ *   @return  True if they overlap.
+ */
+bool CollisionMask::overlaps(const CollisionMask& other,
+                             int offset_x,
+                             int offset_y) const
+{
+  int first_row = std::max(0, offset_y);
+  int last_row = std::min(mask_height, offset_y + other.mask_height);
+  int first_column = std::max(0, offset_x);
+  int last_column = std::min(mask_width, offset_x + other.mask_width);
+  if (first_row >= last_row || first_column >= last_column)
+  {
+    return false;
+  }
+
+  int first_word = first_column / WORD_BITS;
+  int last_word = (last_column - 1) / WORD_BITS;
+  for (int y = first_row; y < last_row; y++)
+  {
+    for (int w = first_word; w <= last_word; w++)
+    {
+      if (word(y, w) & other.bits(y - offset_y, w * WORD_BITS - offset_x))
+      {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool CollisionMask::touching(const rect& lhs,
+                             const CollisionMask* lhs_mask,
+                             const rect& rhs,
+                             const CollisionMask* rhs_mask)
+{
+  if (!lhs.isInside(rhs))
+  {
+    return false;
+  }
+
+  if (!lhs_mask || !rhs_mask)
+  {
+    return true;
+  }
+
+  return lhs_mask->overlaps(*rhs_mask,
+                            static_cast<int>(std::lround(rhs.x - lhs.x)),
+                            static_cast<int>(std::lround(rhs.y - lhs.y)));
+}
+
+bool CollisionMask::solid(int x, int y) const
+{
+  if (x < 0 || y < 0 || x >= mask_width || y >= mask_height)
+  {
+    return false;
+  }
+  return (rows[y * row_words + x / WORD_BITS] >> (x % WORD_BITS)) & 1;
+}
+
+int CollisionMask::width() const
+{
+  return mask_width;
+}
+
+int CollisionMask::height() const
+{
+  return mask_height;
+}
+
+const std::vector<uint64_t>& CollisionMask::words() const
+{
+  return rows;
+}
+
+void CollisionMask::resize(int width, int height)
+{
+  mask_width = width;
+  mask_height = height;
+  row_words = (width + WORD_BITS - 1) / WORD_BITS;
+  rows.assign(static_cast<size_t>(row_words) * height, 0);
+}
+
+/**
+ *   @brief   Reads one of a row's words.
+ *   @return  The word, or no pixels if it is outside the mask.
+ */
+uint64_t CollisionMask::word(int row, int index) const
+{
+  if (index < 0 || index >= row_words)
+  {
+    return 0;
+  }
+  return rows[row * row_words + index];
+}
+
+/**
+ *   @brief   Reads 64 pixels of a row starting at any column.
+ *   @details The pixels are split across at most two words, which are
+ *            shifted together. Columns outside the mask read as clear.
+ *   @return  The pixels, the first in the lowest bit.
+ */
+uint64_t CollisionMask::bits(int row, int column) const
+{
+  int index = column >= 0 ? column / WORD_BITS
+                          : -((-column + WORD_BITS - 1) / WORD_BITS);
+  int shift = column - index * WORD_BITS;
+  uint64_t low = word(row, index) >> shift;
+  uint64_t high = shift == 0 ? 0 : word(row, index + 1) << (WORD_BITS - shift);
+  return low | high;
+}
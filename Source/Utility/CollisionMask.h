@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Rect.h"
+
+const char MASK_MAGIC[4] = { 'S', 'I', 'M', 'K' };
+const uint32_t MASK_VERSION = 1;
+const char MASK_FILE[] = "atlas/masks.bin";
+
+/**
+ *  The header at the start of the collision mask file.
+ *  It is followed by mask_count MaskRecord records sorted by hash, then
+ *  every mask's rows of 64 bit words.
+ */
+struct MaskHeader
+{
+  char magic[4] = { 0, 0, 0, 0 };
+  uint32_t version = 0;
+  uint32_t mask_count = 0;
+  uint32_t reserved = 0;
+};
+
+/**
+ *  Where a source image's mask is in the collision mask file.
+ */
+struct MaskRecord
+{
+  uint64_t path_hash = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint64_t first_word = 0;
+};
+
+static_assert(sizeof(MaskHeader) == 16, "mask header must be packed");
+static_assert(sizeof(MaskRecord) == 24, "mask record must be packed");
+
+/**
+ *  A 1 bit per pixel map of which parts of an image are solid.
+ *  Each row is stored as whole 64 bit words, with the leftmost pixel in
+ *  the lowest bit, and any bits past the right edge left clear. Two
+ *  masks are tested against each other a row at a time by shifting one
+ *  row's words into line with the other's and ANDing them.
+ */
+class CollisionMask
+{
+ public:
+  CollisionMask() = default;
+  ~CollisionMask() = default;
+
+  /**
+   *  Builds a mask from the alpha channel of an image.
+   *  @param [in] rgba The image's pixels, RGBA, rows top to bottom
+   *  @param [in] width The width of the image
+   *  @param [in] height The height of the image
+   *  @param [in] threshold The lowest alpha counted as solid
+   */
+  void
+  fromAlpha(const unsigned char* rgba, int width, int height, int threshold);
+
+  /**
+   *  Builds a mask from rows of words, as stored in the mask file.
+   *  @param [in] words The mask's rows
+   *  @param [in] width The width of the mask
+   *  @param [in] height The height of the mask
+   */
+  void fromWords(const uint64_t* words, int width, int height);
+
+  /**
+   *  Resamples the mask to the size its sprite is drawn at.
+   *  @param [in] width The new width
+   *  @param [in] height The new height
+   *  @return the resampled mask
+   */
+  CollisionMask scaled(int width, int height) const;
+
+  /**
+   *  Do any solid pixels of two masks overlap?
+   *  @param [in] other The other mask
+   *  @param [in] offset_x Where the other mask is relative to this one
+   *  @param [in] offset_y Where the other mask is relative to this one
+   *  @return true if they overlap
+   */
+  bool overlaps(const CollisionMask& other, int offset_x, int offset_y) const;
+
+  /**
+   *  Checks two objects for a collision.
+   *  Their boxes are checked first, and only if those overlap are their
+   *  masks compared. Objects without a mask collide as boxes.
+   *  @param [in] lhs The first object's bounding box
+   *  @param [in] lhs_mask The first object's mask (optional)
+   *  @param [in] rhs The second object's bounding box
+   *  @param [in] rhs_mask The second object's mask (optional)
+   *  @return true if the objects are touching
+   */
+  static bool touching(const rect& lhs,
+                       const CollisionMask* lhs_mask,
+                       const rect& rhs,
+                       const CollisionMask* rhs_mask);
+
+  bool solid(int x, int y) const;
+  int width() const;
+  int height() const;
+  const std::vector<uint64_t>& words() const;
+
+ private:
+  void resize(int width, int height);
+  uint64_t word(int row, int index) const;
+  uint64_t bits(int row, int column) const;
+
+  int mask_width = 0;
+  int mask_height = 0;
+  int row_words = 0;
+  std::vector<uint64_t> rows;
+};
@@ -0,0 +1,206 @@
+#include "DiveSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+// how finely each spline segment is measured before resampling
+const int SEGMENT_STEPS = 32;
+
+/**
+ *   @brief   Evaluates one segment of a Catmull-Rom spline.
+ *   @details The segment runs from p1 to p2, with p0 and p3 shaping the
+ *            tangents at either end.
+ *   @return  The point at t, from 0 to 1, along the segment.
+ */
+static vector2 catmullRom(const vector2& p0,
+                          const vector2& p1,
+                          const vector2& p2,
+                          const vector2& p3,
+                          float t)
+{
+  float t2 = t * t;
+  float t3 = t2 * t;
+  auto blend = [t, t2, t3](float a, float b, float c, float d) {
+    return 0.5f * (2 * b + (c - a) * t + (2 * a - 5 * b + 4 * c - d) * t2 +
+                   (3 * b - a - 3 * c + d) * t3);
+  };
+  return vector2(blend(p0.x, p1.x, p2.x, p3.x), blend(p0.y, p1.y, p2.y, p3.y));
+}
+
+void DiveSystem::reserve(size_t slot_count)
+{
+  slots.resize(slot_count);
+  path_ids.resize(slot_count);
+  distances.resize(slot_count);
+  speeds.resize(slot_count);
+  mirrors.resize(slot_count);
+  offsets_x.assign(slot_count, 0);
+  offsets_y.assign(slot_count, 0);
+  active.assign(slot_count, 0);
+  count = 0;
+}
+
+/**
+ *   @brief   Bakes a spline into a path.
+ *   @details The spline is first walked finely to measure how far along
+ *            it each point lies, then resampled at evenly spaced
+ *            distances. Ships then move along it at a constant speed
+ *            however the control points are spaced.
+ *   @return  The path's id.
+ */
+size_t DiveSystem::addPath(const std::vector<vector2>& points)
+{
+  std::vector<vector2> curve;
+  std::vector<float> lengths;
+  curve.reserve((points.size() - 1) * SEGMENT_STEPS + 1);
+  lengths.reserve(curve.capacity());
+
+  for (size_t i = 0; i + 1 < points.size(); i++)
+  {
+    const vector2& p0 = points[i == 0 ? 0 : i - 1];
+    const vector2& p3 = points[std::min(i + 2, points.size() - 1)];
+    for (int step = 0; step < SEGMENT_STEPS; step++)
+    {
+      float t = static_cast<float>(step) / SEGMENT_STEPS;
+      curve.push_back(catmullRom(p0, points[i], points[i + 1], p3, t));
+    }
+  }
+  curve.push_back(points.back());
+
+  lengths.push_back(0);
+  for (size_t i = 1; i < curve.size(); i++)
+  {
+    float dx = curve[i].x - curve[i - 1].x;
+    float dy = curve[i].y - curve[i - 1].y;
+    lengths.push_back(lengths.back() + std::sqrt(dx * dx + dy * dy));
+  }
+
+  dive_path path;
+  path.length = lengths.back();
+  size_t segment = 1;
+  for (size_t i = 0; i < DIVE_SAMPLES; i++)
+  {
+    float target = path.length * static_cast<float>(i) / (DIVE_SAMPLES - 1);
+    while (segment + 1 < lengths.size() && lengths[segment] < target)
+    {
+      segment++;
+    }
+
+    float span = lengths[segment] - lengths[segment - 1];
+    float blend = span > 0 ? (target - lengths[segment - 1]) / span : 0;
+    blend = std::clamp(blend, 0.0f, 1.0f);
+    const vector2& from = curve[segment - 1];
+    const vector2& to = curve[segment];
+    path.xs[i] = from.x + (to.x - from.x) * blend;
+    path.ys[i] = from.y + (to.y - from.y) * blend;
+  }
+
+  path_table.push_back(path);
+  return path_table.size() - 1;
+}
+
+size_t DiveSystem::paths() const
+{
+  return path_table.size();
+}
+
+float DiveSystem::length(size_t path) const
+{
+  return path_table[path].length;
+}
+
+bool DiveSystem::start(int slot, size_t path, float speed, bool mirror)
+{
+  auto index = static_cast<size_t>(slot);
+  if (active[index] || count >= slots.size())
+  {
+    return false;
+  }
+
+  slots[count] = slot;
+  path_ids[count] = path;
+  distances[count] = 0;
+  speeds[count] = speed;
+  mirrors[count] = mirror ? -1.0f : 1.0f;
+  active[index] = 1;
+  count++;
+  return true;
+}
+
+bool DiveSystem::diving(int slot) const
+{
+  return active[static_cast<size_t>(slot)] != 0;
+}
+
+/**
+ *   @brief   Advances every dive.
+ *   @details One pass moves each dive along its path and writes its
+ *            slot's offset by blending the two nearest samples. A
+ *            second pass swaps finished dives out, which puts their
+ *            ships back in their slots.
+ *   @return  void
+ */
+void DiveSystem::update(float delta_time)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    const dive_path& path = path_table[path_ids[i]];
+    distances[i] = std::min(distances[i] + speeds[i] * delta_time, path.length);
+
+    float index = path.length > 0
+                    ? distances[i] / path.length * (DIVE_SAMPLES - 1)
+                    : DIVE_SAMPLES - 1;
+    auto below = std::min(static_cast<size_t>(index), DIVE_SAMPLES - 2);
+    float blend = index - static_cast<float>(below);
+
+    auto slot = static_cast<size_t>(slots[i]);
+    offsets_x[slot] =
+      mirrors[i] *
+      (path.xs[below] + (path.xs[below + 1] - path.xs[below]) * blend);
+    offsets_y[slot] =
+      path.ys[below] + (path.ys[below + 1] - path.ys[below]) * blend;
+  }
+
+  for (size_t i = 0; i < count;)
+  {
+    if (distances[i] >= path_table[path_ids[i]].length)
+    {
+      auto slot = static_cast<size_t>(slots[i]);
+      offsets_x[slot] = 0;
+      offsets_y[slot] = 0;
+      active[slot] = 0;
+
+      count--;
+      slots[i] = slots[count];
+      path_ids[i] = path_ids[count];
+      distances[i] = distances[count];
+      speeds[i] = speeds[count];
+      mirrors[i] = mirrors[count];
+      continue;
+    }
+    i++;
+  }
+}
+
+float DiveSystem::x(int slot) const
+{
+  return offsets_x[static_cast<size_t>(slot)];
+}
+
+float DiveSystem::y(int slot) const
+{
+  return offsets_y[static_cast<size_t>(slot)];
+}
+
+void DiveSystem::clear()
+{
+  std::fill(offsets_x.begin(), offsets_x.end(), 0.0f);
+  std::fill(offsets_y.begin(), offsets_y.end(), 0.0f);
+  std::fill(active.begin(), active.end(), 0);
+  count = 0;
+}
+
+size_t DiveSystem::size() const
+{
+  return count;
+}
@@ -0,0 +1,161 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Vector2.h"
+
+// the number of evenly spaced points each dive path is baked into
+const size_t DIVE_SAMPLES = 64;
+
+/**
+ *  A dive path, resampled so its points are evenly spaced along it.
+ *  Points are offsets from the diving ship's place in the formation.
+ */
+struct dive_path
+{
+  float xs[DIVE_SAMPLES] = {};
+  float ys[DIVE_SAMPLES] = {};
+  float length = 0;
+};
+
+/**
+ *  A saved copy of the dives in progress.
+ */
+template <size_t N>
+struct dive_snapshot
+{
+  uint32_t count = 0;
+  int32_t slots[N];
+  uint32_t paths[N];
+  float distances[N];
+  float speeds[N];
+  float mirrors[N];
+};
+
+/**
+ *  Sends ships out of the formation along authored paths and back.
+ *  Paths are Catmull-Rom splines that start and end at the ship's slot,
+ *  baked once into fixed size sample buffers. A diving ship's position
+ *  is its slot plus an offset from this system, so it follows the
+ *  formation while it dives and rejoins it exactly when the dive ends.
+ *  Active dives are kept as a structure of arrays and all advanced in
+ *  one pass, with finished dives swapped out like ProjectileSystem.
+ */
+class DiveSystem
+{
+ public:
+  DiveSystem() = default;
+  ~DiveSystem() = default;
+
+  /**
+   *  Allocates storage for every ship slot to dive at once.
+   *  @param [in] slots The number of ship slots
+   */
+  void reserve(size_t slots);
+
+  /**
+   *  Bakes a path from its control points.
+   *  The first and last points should be at the origin so that ships
+   *  leave and rejoin their slot smoothly.
+   *  @param [in] points The spline's control points, at least two
+   *  @return the path's id
+   */
+  size_t addPath(const std::vector<vector2>& points);
+
+  size_t paths() const;
+  float length(size_t path) const;
+
+  /**
+   *  Sends a ship out along a path.
+   *  @param [in] slot The ship's slot
+   *  @param [in] path The path to follow
+   *  @param [in] speed How fast to move along the path in pixels/second
+   *  @param [in] mirror Whether to flip the path horizontally
+   *  @return false if the ship is already diving
+   */
+  bool start(int slot, size_t path, float speed, bool mirror);
+
+  bool diving(int slot) const;
+
+  /**
+   *  Moves every diving ship along its path.
+   *  @param [in] delta_time The time passed in seconds
+   */
+  void update(float delta_time);
+
+  /**
+   *  A slot's offset from its place in the formation.
+   *  Zero for ships that are not diving.
+   */
+  float x(int slot) const;
+  float y(int slot) const;
+
+  /**
+   *  Ends every dive at once.
+   */
+  void clear();
+
+  size_t size() const;
+
+  /**
+   *  Copies the dives in progress into a snapshot.
+   *  @param [out] snapshot The snapshot to fill
+   */
+  template <size_t N> void save(dive_snapshot<N>& snapshot) const
+  {
+    snapshot.count = static_cast<uint32_t>(std::min(count, N));
+    for (size_t i = 0; i < snapshot.count; i++)
+    {
+      snapshot.slots[i] = slots[i];
+      snapshot.paths[i] = static_cast<uint32_t>(path_ids[i]);
+      snapshot.distances[i] = distances[i];
+      snapshot.speeds[i] = speeds[i];
+      snapshot.mirrors[i] = mirrors[i];
+    }
+  }
+
+  /**
+   *  Replaces the dives in progress with those in a snapshot.
+   *  @param [in] snapshot The snapshot to copy from
+   */
+  template <size_t N> void restore(const dive_snapshot<N>& snapshot)
+  {
+    clear();
+    for (size_t i = 0; i < snapshot.count; i++)
+    {
+      auto slot = static_cast<size_t>(snapshot.slots[i]);
+      if (slot >= active.size() || active[slot] ||
+          snapshot.paths[i] >= path_table.size())
+      {
+        continue;
+      }
+
+      slots[count] = snapshot.slots[i];
+      path_ids[count] = snapshot.paths[i];
+      distances[count] = snapshot.distances[i];
+      speeds[count] = snapshot.speeds[i];
+      mirrors[count] = snapshot.mirrors[i];
+      active[slot] = 1;
+      count++;
+    }
+
+    // moving nowhere works out each slot's offset from its distance
+    update(0);
+  }
+
+ private:
+  std::vector<dive_path> path_table;
+
+  std::vector<int> slots;
+  std::vector<size_t> path_ids;
+  std::vector<float> distances;
+  std::vector<float> speeds;
+  std::vector<float> mirrors;
+  size_t count = 0;
+
+  std::vector<float> offsets_x;
+  std::vector<float> offsets_y;
+  std::vector<char> active;
+};
@@ -0,0 +1,339 @@
+#include "Flock.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <utility>
+
+// boids steered per chunk when the update is shared between threads
+const size_t STEER_CHUNK = 512;
+// rings of grid cells a boid searches, each a fraction of its view
+const int NEIGHBOUR_RINGS = 2;
+
+void Flock::reserve(size_t capacity)
+{
+  xs.resize(capacity);
+  ys.resize(capacity);
+  velocity_xs.resize(capacity);
+  velocity_ys.resize(capacity);
+  next_velocity_xs.resize(capacity);
+  next_velocity_ys.resize(capacity);
+  removed.reserve(capacity);
+  grid.reserve(capacity);
+  count = 0;
+}
+
+void Flock::bounds(float area_width, float area_height, float boid_size)
+{
+  width = area_width;
+  height = area_height;
+  size_px = boid_size;
+  grid.resize(width, height, steering.view_radius / NEIGHBOUR_RINGS);
+}
+
+/**
+ *   @brief   Changes the steering rules.
+ *   @details The grid's cells are kept at half the view radius, so a
+ *            boid's neighbours are always within two rings of cells
+ *            around its own.
+ *   @return  void
+ */
+void Flock::rules(const flock_rules& new_rules)
+{
+  steering = new_rules;
+  grid.resize(width, height, steering.view_radius / NEIGHBOUR_RINGS);
+}
+
+bool Flock::spawn(float x, float y, float velocity_x, float velocity_y)
+{
+  if (count >= xs.size())
+  {
+    return false;
+  }
+
+  xs[count] = x;
+  ys[count] = y;
+  velocity_xs[count] = velocity_x;
+  velocity_ys[count] = velocity_y;
+  count++;
+  return true;
+}
+
+/**
+ *   @brief   Steers and moves the flock.
+ *   @details The grid is rebuilt first so every boid sees where its
+ *            neighbours are now, including any spawned since the last
+ *            update, and again after moving for collision checks.
+ *            Steering only reads positions and the current velocities,
+ *            and each boid writes only its own new velocity, so chunks
+ *            of boids can be steered on any thread.
+ *   @return  void
+ */
+void Flock::update(float delta_time,
+                   float target_x,
+                   float target_y,
+                   WorkerPool* workers)
+{
+  grid.build(xs.data(), ys.data(), count);
+
+  auto job = [&](size_t begin, size_t end) {
+    steer(begin, end, delta_time, target_x, target_y);
+  };
+  if (workers)
+  {
+    workers->run(count, STEER_CHUNK, job);
+  }
+  else
+  {
+    job(0, count);
+  }
+
+  std::swap(velocity_xs, next_velocity_xs);
+  std::swap(velocity_ys, next_velocity_ys);
+  move(delta_time);
+  grid.build(xs.data(), ys.data(), count);
+}
+
+/**
+ *   @brief   Works out new velocities for a range of boids.
+ *   @details Each boid looks at up to max_neighbours boids within its
+ *            view radius, searching outwards from its own cell so that
+ *            in a crowd it stops after the nearest few. It is pushed
+ *            away from those that are too close, more strongly the
+ *            closer they are, turned towards their average velocity and
+ *            pulled towards their centre. On top of that it always
+ *            accelerates towards the target.
+ *            The result is kept between the minimum and maximum speeds.
+ *   @return  void
+ */
+void Flock::steer(size_t begin,
+                  size_t end,
+                  float delta_time,
+                  float target_x,
+                  float target_y)
+{
+  const float view_sq = steering.view_radius * steering.view_radius;
+  const float separation_sq =
+    steering.separation_radius * steering.separation_radius;
+  const float half_size = size_px / 2;
+
+  for (size_t i = begin; i < end; i++)
+  {
+    float x = xs[i];
+    float y = ys[i];
+    float velocity_x = velocity_xs[i];
+    float velocity_y = velocity_ys[i];
+
+    int neighbours = 0;
+    float sum_x = 0;
+    float sum_y = 0;
+    float sum_velocity_x = 0;
+    float sum_velocity_y = 0;
+    float push_x = 0;
+    float push_y = 0;
+    grid.queryNearest(x, y, NEIGHBOUR_RINGS, [&](uint32_t j) {
+      float dx = xs[j] - x;
+      float dy = ys[j] - y;
+      float distance_sq = dx * dx + dy * dy;
+      if (j == i || distance_sq >= view_sq)
+      {
+        return true;
+      }
+
+      neighbours++;
+      sum_x += dx;
+      sum_y += dy;
+      sum_velocity_x += velocity_xs[j];
+      sum_velocity_y += velocity_ys[j];
+      if (distance_sq < separation_sq && distance_sq > 0)
+      {
+        push_x -= dx / distance_sq;
+        push_y -= dy / distance_sq;
+      }
+      return neighbours < steering.max_neighbours;
+    });
+
+    float accel_x = 0;
+    float accel_y = 0;
+    if (neighbours > 0)
+    {
+      float scale = 1 / static_cast<float>(neighbours);
+      accel_x += steering.separation * push_x +
+                 steering.alignment * (sum_velocity_x * scale - velocity_x) +
+                 steering.cohesion * sum_x * scale;
+      accel_y += steering.separation * push_y +
+                 steering.alignment * (sum_velocity_y * scale - velocity_y) +
+                 steering.cohesion * sum_y * scale;
+    }
+
+    float chase_x = target_x - (x + half_size);
+    float chase_y = target_y - (y + half_size);
+    float chase_length = std::sqrt(chase_x * chase_x + chase_y * chase_y);
+    if (chase_length > 0)
+    {
+      accel_x += steering.chase * chase_x / chase_length;
+      accel_y += steering.chase * chase_y / chase_length;
+    }
+
+    velocity_x += accel_x * delta_time;
+    velocity_y += accel_y * delta_time;
+    float speed = std::sqrt(velocity_x * velocity_x + velocity_y * velocity_y);
+    float clamped = std::clamp(speed, steering.min_speed, steering.max_speed);
+    if (speed > 0 && clamped != speed)
+    {
+      velocity_x *= clamped / speed;
+      velocity_y *= clamped / speed;
+    }
+    next_velocity_xs[i] = velocity_x;
+    next_velocity_ys[i] = velocity_y;
+  }
+}
+
+/**
+ *   @brief   Moves the boids, bouncing them off the edges of the area.
+ *   @details The moves are separate loops over contiguous floats, which
+ *            the compiler can vectorise. Only the edge checks branch.
+ *   @return  void
+ */
+void Flock::move(float delta_time)
+{
+  float* x = xs.data();
+  float* y = ys.data();
+  const float* velocity_x = velocity_xs.data();
+  const float* velocity_y = velocity_ys.data();
+
+  for (size_t i = 0; i < count; i++)
+  {
+    x[i] += velocity_x[i] * delta_time;
+  }
+  for (size_t i = 0; i < count; i++)
+  {
+    y[i] += velocity_y[i] * delta_time;
+  }
+
+  float right = width - size_px;
+  float bottom = height - size_px;
+  for (size_t i = 0; i < count; i++)
+  {
+    if (x[i] < 0 || x[i] > right)
+    {
+      x[i] = std::clamp(x[i], 0.0f, right);
+      velocity_xs[i] = -velocity_xs[i];
+    }
+    if (y[i] < 0 || y[i] > bottom)
+    {
+      y[i] = std::clamp(y[i], 0.0f, bottom);
+      velocity_ys[i] = -velocity_ys[i];
+    }
+  }
+}
+
+/**
+ *   @brief   Grows an area by a boid's size.
+ *   @details Boids are stored by their top left corner, so any boid
+ *            touching the area has its corner inside the grown area.
+ *   @return  The area to search.
+ */
+rect Flock::searchArea(const rect& target) const
+{
+  rect area = target;
+  area.x -= size_px;
+  area.y -= size_px;
+  area.length += size_px;
+  area.height += size_px;
+  return area;
+}
+
+bool Flock::hits(const rect& target,
+                 const CollisionMask* target_mask,
+                 const CollisionMask* boid_mask) const
+{
+  bool hit = false;
+  grid.query(searchArea(target), [&](uint32_t i) {
+    rect boid;
+    boid.x = xs[i];
+    boid.y = ys[i];
+    boid.length = size_px;
+    boid.height = size_px;
+    hit = CollisionMask::touching(target, target_mask, boid, boid_mask);
+    return !hit;
+  });
+  return hit;
+}
+
+/**
+ *   @brief   Removes the boids touching an area.
+ *   @details The hits are collected first, as removing a boid moves the
+ *            last boid into its place. They are then removed from the
+ *            highest index down, so no boid waiting to be removed is
+ *            ever the one moved. The grid is rebuilt if anything was
+ *            removed, so later checks this frame see the packed boids.
+ *   @return  The number of boids removed.
+ */
+int Flock::destroy(const rect& target,
+                   const CollisionMask* target_mask,
+                   const CollisionMask* boid_mask)
+{
+  removed.clear();
+  grid.query(searchArea(target), [&](uint32_t i) {
+    rect boid;
+    boid.x = xs[i];
+    boid.y = ys[i];
+    boid.length = size_px;
+    boid.height = size_px;
+    if (CollisionMask::touching(target, target_mask, boid, boid_mask))
+    {
+      removed.push_back(i);
+    }
+    return true;
+  });
+
+  if (removed.empty())
+  {
+    return 0;
+  }
+
+  std::sort(removed.begin(), removed.end(), std::greater<uint32_t>());
+  for (auto index : removed)
+  {
+    remove(index);
+  }
+  grid.build(xs.data(), ys.data(), count);
+  return static_cast<int>(removed.size());
+}
+
+void Flock::remove(size_t index)
+{
+  count--;
+  xs[index] = xs[count];
+  ys[index] = ys[count];
+  velocity_xs[index] = velocity_xs[count];
+  velocity_ys[index] = velocity_ys[count];
+}
+
+/**
+ *   @brief   Draws the boids.
+ *   @details Each boid is turned to face the way it is flying. The
+ *            sprite is drawn facing down, the way the invaders face.
+ *   @return  void
+ */
+void Flock::render(ASGE::Renderer* renderer, ASGE::Sprite& sprite) const
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    sprite.xPos(xs[i]);
+    sprite.yPos(ys[i]);
+    sprite.rotationInRadians(std::atan2(-velocity_xs[i], velocity_ys[i]));
+    renderer->renderSprite(sprite);
+  }
+}
+
+void Flock::clear()
+{
+  count = 0;
+}
+
+size_t Flock::size() const
+{
+  return count;
+}
@@ -0,0 +1,180 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <Engine/Renderer.h>
+#include <Engine/Sprite.h>
+
+#include "CollisionMask.h"
+#include "Rect.h"
+#include "Snapshot.h"
+#include "SpatialGrid.h"
+#include "WorkerPool.h"
+
+/**
+ *  How a flock's boids steer. Weights scale each rule's pull, in pixels
+ *  per second squared for each pixel per second of difference.
+ */
+struct flock_rules
+{
+  float view_radius = 28;       /**< How far a boid sees its neighbours. */
+  float separation_radius = 12; /**< How close is too close. */
+  int max_neighbours = 16;      /**< Neighbours looked at per boid. */
+  float separation = 900;       /**< Push away from close neighbours. */
+  float alignment = 1.5f;       /**< Match the neighbours' velocity. */
+  float cohesion = 1.2f;        /**< Move to the neighbours' centre. */
+  float chase = 160;            /**< Acceleration towards the target. */
+  float min_speed = 60;
+  float max_speed = 180;
+};
+
+/**
+ *  A swarm of boids steering by separation, alignment and cohesion while
+ *  chasing a target.
+ *  Boids are stored as a structure of arrays, packed at the front like
+ *  ProjectileSystem's projectiles. Each update sorts them into a
+ *  SpatialGrid with cells half as large as the view radius, so a boid
+ *  only looks at the few cells around it rather than the whole flock. New
+ *  velocities are written to a second set of arrays, which leaves every
+ *  boid's steering independent and lets it be split across a WorkerPool.
+ */
+class Flock
+{
+ public:
+  Flock() = default;
+  ~Flock() = default;
+
+  /**
+   *  Allocates storage for the largest flock.
+   *  @param [in] capacity The most boids
+   */
+  void reserve(size_t capacity);
+
+  /**
+   *  Sets the area the boids are kept inside.
+   *  @param [in] width The width of the area
+   *  @param [in] height The height of the area
+   *  @param [in] boid_size The width and height of a boid
+   */
+  void bounds(float width, float height, float boid_size);
+
+  /**
+   *  Changes how the boids steer.
+   *  @param [in] new_rules The new rules
+   */
+  void rules(const flock_rules& new_rules);
+
+  /**
+   *  Adds a boid.
+   *  @param [in] x The starting position
+   *  @param [in] y The starting position
+   *  @param [in] velocity_x The velocity in pixels per second
+   *  @param [in] velocity_y The velocity in pixels per second
+   *  @return false if the flock is full
+   */
+  bool spawn(float x, float y, float velocity_x, float velocity_y);
+
+  /**
+   *  Steers and moves every boid.
+   *  @param [in] delta_time The time passed in seconds
+   *  @param [in] target_x The point the flock chases
+   *  @param [in] target_y The point the flock chases
+   *  @param [in] workers Threads to share the steering with (optional)
+   */
+  void update(float delta_time,
+              float target_x,
+              float target_y,
+              WorkerPool* workers = nullptr);
+
+  /**
+   *  Is any boid touching an area?
+   *  @param [in] target The area to check
+   *  @param [in] target_mask The target's collision mask (optional)
+   *  @param [in] boid_mask A boid's collision mask (optional)
+   *  @return true if a boid touches the target
+   */
+  bool hits(const rect& target,
+            const CollisionMask* target_mask = nullptr,
+            const CollisionMask* boid_mask = nullptr) const;
+
+  /**
+   *  Removes every boid touching an area.
+   *  @param [in] target The area to check
+   *  @param [in] target_mask The target's collision mask (optional)
+   *  @param [in] boid_mask A boid's collision mask (optional)
+   *  @return the number of boids removed
+   */
+  int destroy(const rect& target,
+              const CollisionMask* target_mask = nullptr,
+              const CollisionMask* boid_mask = nullptr);
+
+  /**
+   *  Draws every boid by moving and turning one sprite to each in turn.
+   *  Relies on the renderer copying the sprite when it is queued.
+   *  @param [in] renderer The renderer to draw with
+   *  @param [in] sprite The sprite to draw each boid with, facing down
+   */
+  void render(ASGE::Renderer* renderer, ASGE::Sprite& sprite) const;
+
+  /**
+   *  Copies every live boid into a snapshot.
+   *  Boids beyond the snapshot's capacity are left out.
+   *  @param [out] snapshot The snapshot to fill
+   */
+  template <size_t N> void save(motion_snapshot<N>& snapshot) const
+  {
+    snapshot.count = static_cast<uint32_t>(std::min(count, N));
+    std::copy_n(xs.data(), snapshot.count, snapshot.xs);
+    std::copy_n(ys.data(), snapshot.count, snapshot.ys);
+    std::copy_n(velocity_xs.data(), snapshot.count, snapshot.velocity_xs);
+    std::copy_n(velocity_ys.data(), snapshot.count, snapshot.velocity_ys);
+  }
+
+  /**
+   *  Replaces every boid with those in a snapshot.
+   *  @param [in] snapshot The snapshot to copy from
+   */
+  template <size_t N> void restore(const motion_snapshot<N>& snapshot)
+  {
+    count = std::min<size_t>(snapshot.count, xs.size());
+    std::copy_n(snapshot.xs, count, xs.data());
+    std::copy_n(snapshot.ys, count, ys.data());
+    std::copy_n(snapshot.velocity_xs, count, velocity_xs.data());
+    std::copy_n(snapshot.velocity_ys, count, velocity_ys.data());
+    grid.build(xs.data(), ys.data(), count);
+  }
+
+  /**
+   *  Removes every boid.
+   */
+  void clear();
+
+  size_t size() const;
+
+ private:
+  void steer(size_t begin,
+             size_t end,
+             float delta_time,
+             float target_x,
+             float target_y);
+  void move(float delta_time);
+  rect searchArea(const rect& target) const;
+  void remove(size_t index);
+
+  std::vector<float> xs;
+  std::vector<float> ys;
+  std::vector<float> velocity_xs;
+  std::vector<float> velocity_ys;
+  std::vector<float> next_velocity_xs;
+  std::vector<float> next_velocity_ys;
+  std::vector<uint32_t> removed;
+  size_t count = 0;
+
+  float width = 0;
+  float height = 0;
+  float size_px = 0;
+  flock_rules steering;
+  SpatialGrid grid;
+};
@@ -0,0 +1,78 @@
+#include "FrameArena.h"
+#include <Engine/DebugPrinter.h>
+
+#include <cstdint>
+
+void FrameArena::reserve(size_t bytes)
+{
+  block = std::make_unique<unsigned char[]>(bytes);
+  block_size = bytes;
+  offset = 0;
+}
+
+/**
+ *   @brief   Bumps the arena's pointer past a new allocation.
+ *   @details The start of the allocation is rounded up to the alignment.
+ *            Allocations that do not fit in the block are given their own
+ *            heap allocation, freed at the next reset.
+ *   @return  The allocated memory.
+ */
+void* FrameArena::allocate(size_t bytes, size_t alignment)
+{
+  auto base = reinterpret_cast<uintptr_t>(block.get());
+  uintptr_t start = (base + offset + alignment - 1) & ~(alignment - 1);
+  size_t end = start - base + bytes;
+  if (block && end <= block_size)
+  {
+    offset = end;
+    return reinterpret_cast<void*>(start);
+  }
+
+  overflow.push_back(std::make_unique<unsigned char[]>(bytes + alignment));
+  overflow_bytes += bytes + alignment;
+  auto spill = reinterpret_cast<uintptr_t>(overflow.back().get());
+  return reinterpret_cast<void*>((spill + alignment - 1) & ~(alignment - 1));
+}
+
+/**
+ *   @brief   Frees the frame's allocations.
+ *   @details Normally this only rewinds the pointer. After a frame that
+ *            overflowed, the block is replaced with one big enough to
+ *            have held the whole frame.
+ *   @return  void
+ */
+void FrameArena::reset()
+{
+  size_t frame_bytes = used();
+  if (frame_bytes > peak_bytes)
+  {
+    peak_bytes = frame_bytes;
+#ifndef NDEBUG
+    ASGE::DebugPrinter{} << "Frame arena peak: " << peak_bytes << " of "
+                         << block_size << " bytes" << std::endl;
+#endif
+  }
+
+  if (!overflow.empty())
+  {
+    overflow.clear();
+    overflow_bytes = 0;
+    reserve(block_size * 2 > frame_bytes ? block_size * 2 : frame_bytes);
+  }
+  offset = 0;
+}
+
+size_t FrameArena::used() const
+{
+  return offset + overflow_bytes;
+}
+
+size_t FrameArena::capacity() const
+{
+  return block_size;
+}
+
+size_t FrameArena::peak() const
+{
+  return peak_bytes;
+}
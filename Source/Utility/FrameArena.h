@@ -0,0 +1,108 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ *  A linear allocator for data that only lives for one frame.
+ *  Allocations bump a pointer through one preallocated block and are
+ *  never freed individually; reset() at the end of the frame makes the
+ *  whole block available again. If a frame needs more than the block
+ *  holds the extra comes from the heap, and the block is grown to fit at
+ *  the next reset so later frames do not overflow again.
+ *  Debug builds report each frame that reaches a new peak usage.
+ *  @see ArenaAllocator
+ */
+class FrameArena
+{
+ public:
+  FrameArena() = default;
+  ~FrameArena() = default;
+  FrameArena(const FrameArena&) = delete;
+  FrameArena& operator=(const FrameArena&) = delete;
+
+  /**
+   *  Allocates the arena's block.
+   *  @param [in] bytes The most memory expected to be used in a frame
+   */
+  void reserve(size_t bytes);
+
+  /**
+   *  Allocates memory that is valid until the next reset.
+   *  @param [in] bytes The size of the allocation
+   *  @param [in] alignment The alignment of the allocation
+   *  @return the memory
+   */
+  void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+  /**
+   *  Allocates uninitialised storage for an array of objects.
+   *  @param [in] count The number of objects
+   *  @return the storage
+   */
+  template <typename T>
+  T* allocate(size_t count)
+  {
+    return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+  }
+
+  /**
+   *  Frees everything allocated since the last reset.
+   *  Call once at the end of every frame.
+   */
+  void reset();
+
+  size_t used() const;
+  size_t capacity() const;
+  size_t peak() const;
+
+ private:
+  std::unique_ptr<unsigned char[]> block;
+  size_t block_size = 0;
+  size_t offset = 0;
+
+  std::vector<std::unique_ptr<unsigned char[]>> overflow;
+  size_t overflow_bytes = 0;
+  size_t peak_bytes = 0;
+};
+
+/**
+ *  Lets standard containers allocate from a FrameArena.
+ *  Deallocation does nothing, the memory is reclaimed when the arena is
+ *  reset, so a container using it must not outlive the frame, e.g.
+ *  std::vector<int, ArenaAllocator<int>> ids{ ArenaAllocator<int>(arena) };
+ */
+template <typename T>
+class ArenaAllocator
+{
+ public:
+  using value_type = T;
+
+  explicit ArenaAllocator(FrameArena& arena) noexcept : frame_arena(&arena) {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) noexcept :
+    frame_arena(other.arena())
+  {
+  }
+
+  T* allocate(size_t count) { return frame_arena->allocate<T>(count); }
+  void deallocate(T*, size_t) noexcept {}
+
+  FrameArena* arena() const noexcept { return frame_arena; }
+
+ private:
+  FrameArena* frame_arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs)
+{
+  return lhs.arena() == rhs.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs)
+{
+  return !(lhs == rhs);
+}
@@ -0,0 +1,54 @@
+#include "FrameScheduler.h"
+
+#include <algorithm>
+
+// provided by GLFW, which ASGE links and drives the window with
+extern "C" void glfwWaitEventsTimeout(double timeout);
+
+void FrameScheduler::wake()
+{
+  dirty = true;
+}
+
+/**
+ *   @brief   Blocks an idle frame until there is something to draw.
+ *   @details A frame that follows a change is never held back, so the
+ *            change is drawn straight away. Otherwise a static scene
+ *            waits on the window system, whose event processing runs
+ *            the input callbacks on this thread before returning. The
+ *            timeout keeps the window repainting now and then, e.g.
+ *            after being uncovered, and lets an exit signal be noticed.
+ *   @return  void
+ */
+void FrameScheduler::wait(bool scene_static)
+{
+  if (!scene_static || dirty)
+  {
+    dirty = false;
+    return;
+  }
+
+  glfwWaitEventsTimeout(IDLE_FRAME_TIMEOUT.count() / 1000.0);
+  held = true;
+  woke = std::chrono::steady_clock::now();
+}
+
+/**
+ *   @brief   Takes the time spent idle out of a frame's delta time.
+ *   @details Only the frame straight after a wait is changed. It gets
+ *            the time from the end of the wait to now, which is how
+ *            long the last frame took once it was woken.
+ *   @return  The delta time to play the frame with, in milliseconds.
+ */
+double FrameScheduler::delta(double delta_ms)
+{
+  if (!held)
+  {
+    return delta_ms;
+  }
+
+  held = false;
+  std::chrono::duration<double, std::milli> awake =
+    std::chrono::steady_clock::now() - woke;
+  return std::min(delta_ms, awake.count());
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <chrono>
+
+/** The longest an idle screen goes without being redrawn. */
+const std::chrono::milliseconds IDLE_FRAME_TIMEOUT{ 500 };
+
+/**
+ *  Decides whether the game loop needs to run at full rate.
+ *  ASGE always updates, renders and presents a frame on each pass of its
+ *  loop, so the only way to stop redrawing an unchanging scene is to not
+ *  come back round the loop. When the scene is static and nothing has
+ *  woken the scheduler since the last frame, wait() blocks the main
+ *  thread in the window system until an input event arrives, so an idle
+ *  screen redraws once per event instead of as fast as it can.
+ */
+class FrameScheduler
+{
+ public:
+  FrameScheduler() = default;
+  ~FrameScheduler() = default;
+
+  /**
+   *  Notes that the scene has changed and must be redrawn.
+   *  Call from input callbacks and on game state changes.
+   */
+  void wake();
+
+  /**
+   *  Sleeps until the next input event if the scene is static.
+   *  Call once per frame, before rendering.
+   *  @param [in] scene_static Whether anything on screen can change
+   *                           without input
+   */
+  void wait(bool scene_static);
+
+  /**
+   *  Takes the time spent idle out of a frame's delta time.
+   *  The engine measures a frame's delta before update runs, so the
+   *  frame after one held back by wait() would otherwise cover the
+   *  whole wait. Its delta is cut to the time since the wait ended.
+   *  Call once per frame, before wait().
+   *  @param [in] delta_ms The engine's delta time in milliseconds
+   *  @return the delta time to play the frame with, in milliseconds
+   */
+  double delta(double delta_ms);
+
+ private:
+  bool dirty = true;
+  bool held = false; /**< Whether the last frame waited. */
+  std::chrono::steady_clock::time_point woke;
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+const uint64_t FNV_PRIME = 1099511628211ull;
+
+/**
+ *  Hashes a block of bytes using 64 bit FNV-1a.
+ *  Used to key assets by path and by contents. Not suitable for
+ *  anything security related.
+ *  @param [in] data The bytes to hash
+ *  @param [in] length The number of bytes to hash
+ *  @param [in] seed A previous hash to continue from
+ *  @return the 64 bit hash
+ */
+inline uint64_t
+hashBytes(const void* data, size_t length, uint64_t seed = FNV_OFFSET_BASIS)
+{
+  auto bytes = static_cast<const unsigned char*>(data);
+  uint64_t hash = seed;
+  for (size_t i = 0; i < length; i++)
+  {
+    hash ^= bytes[i];
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+/**
+ *  Hashes an asset path.
+ *  Paths are relative to the GameData folder and always use forward
+ *  slashes, i.e. "images/enemyRed1.png".
+ *  @param [in] path The path to hash
+ *  @return the 64 bit hash
+ */
+inline uint64_t hashPath(const std::string& path)
+{
+  return hashBytes(path.data(), path.size());
+}
@@ -0,0 +1,91 @@
+#include "MaskLibrary.h"
+#include "AssetData.h"
+#include "Hash.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+/**
+ *   @brief   Loads and validates the collision mask file.
+ *   @details Every record is checked to lie within the file before any
+ *            mask is built from it.
+ *   @return  True if the file was found and is valid.
+ */
+bool MaskLibrary::load(const AssetArchive* archive)
+{
+  sources.clear();
+  scaled_masks.clear();
+
+  AssetData file;
+  if (!file.load(archive, MASK_FILE) || file.size() < sizeof(MaskHeader))
+  {
+    return false;
+  }
+
+  MaskHeader header;
+  std::memcpy(&header, file.data(), sizeof(header));
+  size_t words_start = sizeof(header) + header.mask_count * sizeof(MaskRecord);
+  if (std::memcmp(header.magic, MASK_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != MASK_VERSION || file.size() < words_start)
+  {
+    return false;
+  }
+
+  size_t word_count = (file.size() - words_start) / sizeof(uint64_t);
+  std::vector<uint64_t> words(word_count);
+  std::memcpy(
+    words.data(), file.data() + words_start, word_count * sizeof(uint64_t));
+
+  sources.resize(header.mask_count);
+  for (uint32_t i = 0; i < header.mask_count; i++)
+  {
+    MaskRecord record;
+    std::memcpy(&record,
+                file.data() + sizeof(header) + i * sizeof(MaskRecord),
+                sizeof(record));
+
+    size_t row_words = (record.width + 63) / 64;
+    if (record.first_word + row_words * record.height > word_count)
+    {
+      sources.clear();
+      return false;
+    }
+
+    sources[i].path_hash = record.path_hash;
+    sources[i].mask.fromWords(&words[record.first_word],
+                              static_cast<int>(record.width),
+                              static_cast<int>(record.height));
+  }
+  return true;
+}
+
+const CollisionMask* MaskLibrary::find(const std::string& texture_file_name,
+                                       float width,
+                                       float height)
+{
+  uint64_t hash = hashPath(texture_file_name);
+  auto source = std::lower_bound(
+    sources.begin(),
+    sources.end(),
+    hash,
+    [](const source_mask& lhs, uint64_t rhs) { return lhs.path_hash < rhs; });
+
+  if (source == sources.end() || source->path_hash != hash)
+  {
+    return nullptr;
+  }
+
+  auto key = std::make_tuple(hash,
+                             static_cast<int>(std::lround(width)),
+                             static_cast<int>(std::lround(height)));
+  auto scaled = scaled_masks.find(key);
+  if (scaled == scaled_masks.end())
+  {
+    scaled = scaled_masks
+               .emplace(key,
+                        source->mask.scaled(std::get<1>(key), std::get<2>(key)))
+               .first;
+  }
+  return &scaled->second;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "CollisionMask.h"
+
+class AssetArchive;
+
+/**
+ *  The collision masks generated at build time by the AtlasPacker tool.
+ *  The file holds one mask per image at the image's own size. Sprites are
+ *  drawn at other sizes, so each mask is resampled to a sprite's size the
+ *  first time it is asked for and kept, which happens while the sprites
+ *  are loading rather than during play.
+ *  @see CollisionMask
+ */
+class MaskLibrary
+{
+ public:
+  MaskLibrary() = default;
+  ~MaskLibrary() = default;
+
+  /**
+   *  Loads the collision mask file.
+   *  @param [in] archive The packed archive to read from (optional)
+   *  @return true if masks are available
+   */
+  bool load(const AssetArchive* archive);
+
+  /**
+   *  Finds the mask for an image drawn at a given size.
+   *  @param [in] texture_file_name The original image path
+   *  @param [in] width The width the image is drawn at
+   *  @param [in] height The height the image is drawn at
+   *  @return the mask, or nullptr if the image has none
+   */
+  const CollisionMask*
+  find(const std::string& texture_file_name, float width, float height);
+
+ private:
+  struct source_mask
+  {
+    uint64_t path_hash = 0;
+    CollisionMask mask;
+  };
+
+  std::vector<source_mask> sources;
+  std::map<std::tuple<uint64_t, int, int>, CollisionMask> scaled_masks;
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ *  A fixed capacity slab of objects.
+ *  Every object lives in one contiguous block allocated by reserve(), so
+ *  handing one out or taking it back never touches the heap. Released
+ *  objects are not destroyed, only made available again, so anything they
+ *  own (such as a component's sprite) is reused by the next acquire().
+ *  Objects are destroyed with the pool.
+ *  Pools whose users all let go at once are emptied with releaseAll(),
+ *  such as the ships' sprite components when a wave ends and the running
+ *  scripts when they are cleared. Objects are then handed out again from
+ *  the front of the slab, in the same order as before.
+ */
+template <typename T>
+class ObjectPool
+{
+ public:
+  ObjectPool() = default;
+  ~ObjectPool() = default;
+  ObjectPool(const ObjectPool&) = delete;
+  ObjectPool& operator=(const ObjectPool&) = delete;
+
+  /**
+   *  Allocates the slab.
+   *  Destroys any objects already in the pool, so call it once, before
+   *  handing any out.
+   *  @param [in] capacity The most objects in use at once
+   */
+  void reserve(size_t capacity)
+  {
+    objects = std::make_unique<T[]>(capacity);
+    free_slots.clear();
+    free_slots.reserve(capacity);
+    slot_count = capacity;
+    used = 0;
+  }
+
+  /**
+   *  Hands out an unused object.
+   *  @return the object, or nullptr if every object is in use
+   */
+  T* acquire()
+  {
+    if (!free_slots.empty())
+    {
+      T* object = free_slots.back();
+      free_slots.pop_back();
+      return object;
+    }
+
+    if (used < slot_count)
+    {
+      return &objects[used++];
+    }
+    return nullptr;
+  }
+
+  /**
+   *  Returns an object to the pool.
+   *  @param [in] object An object handed out by this pool
+   */
+  void release(T* object) { free_slots.push_back(object); }
+
+  /**
+   *  Returns every object to the pool at once.
+   *  Nothing is walked or destroyed, so this takes the same time however
+   *  many objects are in use. Pointers to the objects must not be used
+   *  again until they are handed back out, so only call it once nothing
+   *  holds one, e.g. when every running script is dropped.
+   */
+  void releaseAll()
+  {
+    free_slots.clear();
+    used = 0;
+  }
+
+  size_t capacity() const { return slot_count; }
+  size_t size() const { return used - free_slots.size(); }
+
+  /**
+   *  The number of objects handed out since the pool was last emptied.
+   *  Every object in use has an index below this, as do any released
+   *  since, so walking up to it finds every object in use.
+   */
+  size_t span() const { return used; }
+
+  T& operator[](size_t index) { return objects[index]; }
+  const T& operator[](size_t index) const { return objects[index]; }
+
+ private:
+  std::unique_ptr<T[]> objects;
+  std::vector<T*> free_slots;
+  size_t slot_count = 0;
+  size_t used = 0;
+};
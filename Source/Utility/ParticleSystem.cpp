@@ -0,0 +1,187 @@
+#include "ParticleSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// the fraction of its speed a particle loses every second
+const float PARTICLE_DRAG = 1.5f;
+
+/**
+ *   @brief   Picks a random number between 0 and 1.
+ *   @return  The number.
+ */
+static float randomUnit()
+{
+  return static_cast<float>(std::rand()) / RAND_MAX;
+}
+
+void ParticleSystem::reserve(size_t capacity)
+{
+  xs.resize(capacity);
+  ys.resize(capacity);
+  velocity_xs.resize(capacity);
+  velocity_ys.resize(capacity);
+  lives.resize(capacity);
+  fade_rates.resize(capacity);
+  opacities.resize(capacity);
+  colours.resize(capacity, ASGE::COLOURS::WHITE);
+  clear();
+}
+
+void ParticleSystem::spawn(float x,
+                           float y,
+                           float velocity_x,
+                           float velocity_y,
+                           float lifetime,
+                           const ASGE::Colour& colour)
+{
+  if (xs.empty() || lifetime <= 0)
+  {
+    return;
+  }
+
+  size_t slot = count;
+  if (count < xs.size())
+  {
+    count++;
+  }
+  else
+  {
+    slot = next;
+    next = (next + 1) % xs.size();
+  }
+
+  xs[slot] = x;
+  ys[slot] = y;
+  velocity_xs[slot] = velocity_x;
+  velocity_ys[slot] = velocity_y;
+  lives[slot] = lifetime;
+  fade_rates[slot] = 1 / lifetime;
+  opacities[slot] = 1;
+  colours[slot] = colour;
+}
+
+/**
+ *   @brief   Spawns a burst of particles.
+ *   @details Each particle flies off at a random angle and speed and
+ *            lives for a random time, so the burst is a soft disc rather
+ *            than a ring.
+ *   @return  void
+ */
+void ParticleSystem::burst(float x,
+                           float y,
+                           int burst_count,
+                           float speed,
+                           float lifetime,
+                           const ASGE::Colour& colour)
+{
+  const float two_pi = 6.28318530718f;
+  for (int i = 0; i < burst_count; i++)
+  {
+    float angle = two_pi * randomUnit();
+    float particle_speed = speed * (0.2f + 0.8f * randomUnit());
+    spawn(x,
+          y,
+          std::cos(angle) * particle_speed,
+          std::sin(angle) * particle_speed,
+          lifetime * (0.5f + 0.5f * randomUnit()),
+          colour);
+  }
+}
+
+/**
+ *   @brief   Moves and fades the particles.
+ *   @details Every live particle is updated, including any that fade
+ *            out this frame, so each loop runs without branches. Those
+ *            that have faded out are then dropped.
+ *   @return  void
+ */
+void ParticleSystem::update(float delta_time)
+{
+  float* x = xs.data();
+  float* y = ys.data();
+  float* velocity_x = velocity_xs.data();
+  float* velocity_y = velocity_ys.data();
+  float* life = lives.data();
+  const float* fade_rate = fade_rates.data();
+  float* opacity = opacities.data();
+  float drag = std::max(0.0f, 1 - PARTICLE_DRAG * delta_time);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    x[i] += velocity_x[i] * delta_time;
+    velocity_x[i] *= drag;
+  }
+  for (size_t i = 0; i < count; i++)
+  {
+    y[i] += velocity_y[i] * delta_time;
+    velocity_y[i] *= drag;
+  }
+  for (size_t i = 0; i < count; i++)
+  {
+    life[i] -= delta_time;
+    opacity[i] = std::max(life[i] * fade_rate[i], 0.0f);
+  }
+
+  compact();
+}
+
+/**
+ *   @brief   Drops the particles that have faded out.
+ *   @details Live particles slide down over the dead ones, keeping their
+ *            order, so the live particles stay packed at the front.
+ *            Particles that are still in place are not copied.
+ *   @return  void
+ */
+void ParticleSystem::compact()
+{
+  size_t live = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    if (lives[i] <= 0)
+    {
+      continue;
+    }
+
+    if (live != i)
+    {
+      xs[live] = xs[i];
+      ys[live] = ys[i];
+      velocity_xs[live] = velocity_xs[i];
+      velocity_ys[live] = velocity_ys[i];
+      lives[live] = lives[i];
+      fade_rates[live] = fade_rates[i];
+      opacities[live] = opacities[i];
+      colours[live] = colours[i];
+    }
+    live++;
+  }
+
+  count = live;
+  next = 0;
+}
+
+void ParticleSystem::render(ASGE::Renderer* renderer,
+                            ASGE::Sprite& sprite) const
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    sprite.xPos(xs[i]);
+    sprite.yPos(ys[i]);
+    sprite.opacity(opacities[i]);
+    sprite.colour(colours[i]);
+    renderer->renderSprite(sprite);
+  }
+}
+
+void ParticleSystem::clear()
+{
+  next = 0;
+  count = 0;
+}
+
+size_t ParticleSystem::size() const
+{
+  return count;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include <Engine/Colours.h>
+#include <Engine/Renderer.h>
+#include <Engine/Sprite.h>
+
+/**
+ *  Short lived, purely visual particles, such as explosions and trails.
+ *  Particles are stored as a structure of arrays of a fixed size, with
+ *  the live particles packed at the front. Spawning takes the slot after
+ *  the last live particle, or once every slot is in use replaces each
+ *  slot in turn, so there is never a search for a free slot and never an
+ *  allocation. Moving and fading are separate tight loops over
+ *  contiguous floats, written so the compiler can vectorise them.
+ *  Particles that have faded out are then dropped in one pass that
+ *  slides the rest down, so only live particles are updated and drawn.
+ */
+class ParticleSystem
+{
+ public:
+  ParticleSystem() = default;
+  ~ParticleSystem() = default;
+
+  /**
+   *  Allocates the arrays.
+   *  @param [in] capacity The most particles alive at once
+   */
+  void reserve(size_t capacity);
+
+  /**
+   *  Spawns a single particle.
+   *  @param [in] x The starting position
+   *  @param [in] y The starting position
+   *  @param [in] velocity_x The velocity in pixels per second
+   *  @param [in] velocity_y The velocity in pixels per second
+   *  @param [in] lifetime How long the particle takes to fade out
+   *  @param [in] colour The particle's tint
+   */
+  void spawn(float x,
+             float y,
+             float velocity_x,
+             float velocity_y,
+             float lifetime,
+             const ASGE::Colour& colour);
+
+  /**
+   *  Spawns a burst of particles flying out from a point.
+   *  @param [in] x The centre of the burst
+   *  @param [in] y The centre of the burst
+   *  @param [in] count The number of particles
+   *  @param [in] speed The fastest a particle leaves the centre
+   *  @param [in] lifetime The longest a particle lives
+   *  @param [in] colour The particles' tint
+   */
+  void burst(float x,
+             float y,
+             int count,
+             float speed,
+             float lifetime,
+             const ASGE::Colour& colour);
+
+  /**
+   *  Moves, slows and fades every particle, dropping those faded out.
+   *  @param [in] delta_time The time passed in seconds
+   */
+  void update(float delta_time);
+
+  /**
+   *  Draws every live particle by moving one sprite to each in turn.
+   *  Relies on the renderer copying the sprite when it is queued.
+   *  @param [in] renderer The renderer to draw with
+   *  @param [in] sprite The sprite to draw each particle with
+   */
+  void render(ASGE::Renderer* renderer, ASGE::Sprite& sprite) const;
+
+  /**
+   *  Removes every particle.
+   */
+  void clear();
+
+  /**
+   *  The number of live particles.
+   *  @return the particle count
+   */
+  size_t size() const;
+
+ private:
+  void compact();
+
+  std::vector<float> xs;
+  std::vector<float> ys;
+  std::vector<float> velocity_xs;
+  std::vector<float> velocity_ys;
+  std::vector<float> lives;
+  std::vector<float> fade_rates;
+  std::vector<float> opacities;
+  std::vector<ASGE::Colour> colours;
+
+  size_t next = 0; /**< The slot to replace next once all are in use. */
+  size_t count = 0;
+};
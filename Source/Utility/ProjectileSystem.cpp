@@ -0,0 +1,134 @@
+#include "ProjectileSystem.h"
+
+// large enough that most cells hold a handful of projectiles at most
+const float GRID_CELL_SIZE = 32;
+
+void ProjectileSystem::reserve(size_t capacity)
+{
+  xs.resize(capacity);
+  ys.resize(capacity);
+  velocity_xs.resize(capacity);
+  velocity_ys.resize(capacity);
+  grid.reserve(capacity);
+  count = 0;
+}
+
+void ProjectileSystem::bounds(float area_width,
+                              float area_height,
+                              float projectile_size)
+{
+  width = area_width;
+  height = area_height;
+  size_px = projectile_size;
+  grid.resize(width, height, GRID_CELL_SIZE);
+}
+
+bool ProjectileSystem::spawn(float x,
+                             float y,
+                             float velocity_x,
+                             float velocity_y)
+{
+  if (count >= xs.size())
+  {
+    return false;
+  }
+
+  xs[count] = x;
+  ys[count] = y;
+  velocity_xs[count] = velocity_x;
+  velocity_ys[count] = velocity_y;
+  count++;
+  return true;
+}
+
+/**
+ *   @brief   Moves the projectiles and rebuilds the collision grid.
+ *   @details Each axis is moved in its own loop over contiguous floats,
+ *            which the compiler can vectorise. Projectiles entirely
+ *            outside the play area are then swapped out with the last
+ *            live projectile.
+ *   @return  void
+ */
+void ProjectileSystem::update(float delta_time)
+{
+  float* x = xs.data();
+  float* y = ys.data();
+  const float* velocity_x = velocity_xs.data();
+  const float* velocity_y = velocity_ys.data();
+
+  for (size_t i = 0; i < count; i++)
+  {
+    x[i] += velocity_x[i] * delta_time;
+  }
+  for (size_t i = 0; i < count; i++)
+  {
+    y[i] += velocity_y[i] * delta_time;
+  }
+
+  for (size_t i = 0; i < count;)
+  {
+    if (x[i] < -size_px || x[i] > width || y[i] < -size_px || y[i] > height)
+    {
+      count--;
+      xs[i] = xs[count];
+      ys[i] = ys[count];
+      velocity_xs[i] = velocity_xs[count];
+      velocity_ys[i] = velocity_ys[count];
+      continue;
+    }
+    i++;
+  }
+
+  grid.build(xs.data(), ys.data(), count);
+}
+
+/**
+ *   @brief   Checks the projectiles near an area for overlaps.
+ *   @details The search area is grown by a projectile's size, as
+ *            projectiles are stored by their top left corner.
+ *   @return  True if any projectile touches the target.
+ */
+bool ProjectileSystem::hits(const rect& target,
+                            const CollisionMask* target_mask,
+                            const CollisionMask* projectile_mask) const
+{
+  rect area = target;
+  area.x -= size_px;
+  area.y -= size_px;
+  area.length += size_px;
+  area.height += size_px;
+
+  bool hit = false;
+  grid.query(area, [&](uint32_t i) {
+    rect projectile;
+    projectile.x = xs[i];
+    projectile.y = ys[i];
+    projectile.length = size_px;
+    projectile.height = size_px;
+    hit = CollisionMask::touching(
+      target, target_mask, projectile, projectile_mask);
+    return !hit;
+  });
+  return hit;
+}
+
+void ProjectileSystem::render(ASGE::Renderer* renderer,
+                              ASGE::Sprite& sprite) const
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    sprite.xPos(xs[i]);
+    sprite.yPos(ys[i]);
+    renderer->renderSprite(sprite);
+  }
+}
+
+void ProjectileSystem::clear()
+{
+  count = 0;
+}
+
+size_t ProjectileSystem::size() const
+{
+  return count;
+}
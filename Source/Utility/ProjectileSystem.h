@@ -0,0 +1,127 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <Engine/Renderer.h>
+#include <Engine/Sprite.h>
+
+#include "CollisionMask.h"
+#include "Rect.h"
+#include "Snapshot.h"
+#include "SpatialGrid.h"
+
+/**
+ *  A large number of identical, simple projectiles.
+ *  Projectiles are stored as a structure of arrays and moved in tight
+ *  loops over each array. Anything that leaves the play area is removed
+ *  by swapping the last projectile into its place, so the live
+ *  projectiles are always packed at the front of the arrays. After each
+ *  update they are sorted into a SpatialGrid so collision checks only
+ *  look at the projectiles near the target.
+ */
+class ProjectileSystem
+{
+ public:
+  ProjectileSystem() = default;
+  ~ProjectileSystem() = default;
+
+  /**
+   *  Allocates storage for the most projectiles alive at once.
+   *  @param [in] capacity The most live projectiles
+   */
+  void reserve(size_t capacity);
+
+  /**
+   *  Sets the play area. Projectiles that leave it are removed.
+   *  @param [in] width The width of the play area
+   *  @param [in] height The height of the play area
+   *  @param [in] projectile_size The width and height of a projectile
+   */
+  void bounds(float width, float height, float projectile_size);
+
+  /**
+   *  Fires a projectile.
+   *  @param [in] x The starting position
+   *  @param [in] y The starting position
+   *  @param [in] velocity_x The velocity in pixels per second
+   *  @param [in] velocity_y The velocity in pixels per second
+   *  @return false if there is no room for another projectile
+   */
+  bool spawn(float x, float y, float velocity_x, float velocity_y);
+
+  /**
+   *  Moves every projectile and removes those that left the play area.
+   *  @param [in] delta_time The time passed in seconds
+   */
+  void update(float delta_time);
+
+  /**
+   *  Is any projectile touching an area?
+   *  When masks are given, projectiles whose boxes overlap the area are
+   *  then checked pixel by pixel.
+   *  @param [in] target The area to check
+   *  @param [in] target_mask The target's collision mask (optional)
+   *  @param [in] projectile_mask A projectile's collision mask (optional)
+   *  @return true if a projectile touches the target
+   */
+  bool hits(const rect& target,
+            const CollisionMask* target_mask = nullptr,
+            const CollisionMask* projectile_mask = nullptr) const;
+
+  /**
+   *  Draws every projectile by moving one sprite to each in turn.
+   *  Relies on the renderer copying the sprite when it is queued.
+   *  @param [in] renderer The renderer to draw with
+   *  @param [in] sprite The sprite to draw each projectile with
+   */
+  void render(ASGE::Renderer* renderer, ASGE::Sprite& sprite) const;
+
+  /**
+   *  Copies every live projectile into a snapshot.
+   *  Projectiles beyond the snapshot's capacity are left out.
+   *  @param [out] snapshot The snapshot to fill
+   */
+  template <size_t N> void save(motion_snapshot<N>& snapshot) const
+  {
+    snapshot.count = static_cast<uint32_t>(std::min(count, N));
+    std::copy_n(xs.data(), snapshot.count, snapshot.xs);
+    std::copy_n(ys.data(), snapshot.count, snapshot.ys);
+    std::copy_n(velocity_xs.data(), snapshot.count, snapshot.velocity_xs);
+    std::copy_n(velocity_ys.data(), snapshot.count, snapshot.velocity_ys);
+  }
+
+  /**
+   *  Replaces every projectile with those in a snapshot.
+   *  @param [in] snapshot The snapshot to copy from
+   */
+  template <size_t N> void restore(const motion_snapshot<N>& snapshot)
+  {
+    count = std::min<size_t>(snapshot.count, xs.size());
+    std::copy_n(snapshot.xs, count, xs.data());
+    std::copy_n(snapshot.ys, count, ys.data());
+    std::copy_n(snapshot.velocity_xs, count, velocity_xs.data());
+    std::copy_n(snapshot.velocity_ys, count, velocity_ys.data());
+    grid.build(xs.data(), ys.data(), count);
+  }
+
+  /**
+   *  Removes every projectile.
+   */
+  void clear();
+
+  size_t size() const;
+
+ private:
+  std::vector<float> xs;
+  std::vector<float> ys;
+  std::vector<float> velocity_xs;
+  std::vector<float> velocity_ys;
+  size_t count = 0;
+
+  float width = 0;
+  float height = 0;
+  float size_px = 0;
+  SpatialGrid grid;
+};
@@ -0,0 +1,176 @@
+#include "RenderQueue.h"
+#include "Rect.h"
+
+#include <algorithm>
+#include <utility>
+
+void RenderQueue::viewport(float width, float height)
+{
+  view_width = width;
+  view_height = height;
+}
+
+void RenderQueue::reserve(size_t sprites)
+{
+  entries.reserve(sprites);
+}
+
+void RenderQueue::begin()
+{
+  entries.clear();
+  culled_count = 0;
+  texture_changes = 0;
+  unsorted_changes = 0;
+}
+
+/**
+ *   @brief   Queues a sprite for drawing.
+ *   @details The sprite is tested against the viewport first, and only
+ *            kept if some part of it is visible. Its sort key packs the
+ *            layer above the texture so one sort orders by both. The
+ *            texture changes drawing in this order would make are
+ *            counted, to compare against the sorted order.
+ *   @return  void
+ */
+void RenderQueue::add(const ASGE::Sprite& sprite, RenderLayer layer)
+{
+  rect bounds;
+  bounds.x = sprite.xPos();
+  bounds.y = sprite.yPos();
+  bounds.length = sprite.width();
+  bounds.height = sprite.height();
+
+  rect view;
+  view.length = view_width;
+  view.height = view_height;
+
+  if (!bounds.isInside(view))
+  {
+    culled_count++;
+    return;
+  }
+
+  uint32_t texture = textureId(sprite.getTexture());
+  if (entries.empty() || (entries.back().key & 0xFFFF) != texture)
+  {
+    unsorted_changes++;
+  }
+
+  uint32_t key = (static_cast<uint32_t>(layer) << 16) | texture;
+  entries.push_back(Entry{ key, &sprite });
+}
+
+/**
+ *   @brief   Draws the queued sprites.
+ *   @details Sprites are drawn in key order, so the renderer sees every
+ *            sprite using a texture together within each layer.
+ *   @return  void
+ */
+void RenderQueue::submit(ASGE::Renderer* renderer, FrameArena& arena)
+{
+  sort(arena);
+
+  const uint32_t texture_mask = 0xFFFF;
+  uint32_t last_texture = texture_mask + 1;
+  for (const auto& entry : entries)
+  {
+    if ((entry.key & texture_mask) != last_texture)
+    {
+      last_texture = entry.key & texture_mask;
+      texture_changes++;
+    }
+    renderer->renderSprite(*entry.sprite);
+  }
+}
+
+int RenderQueue::submitted() const
+{
+  return static_cast<int>(entries.size());
+}
+
+int RenderQueue::culled() const
+{
+  return culled_count;
+}
+
+int RenderQueue::textureChanges() const
+{
+  return texture_changes;
+}
+
+int RenderQueue::unsortedTextureChanges() const
+{
+  return unsorted_changes;
+}
+
+/**
+ *   @brief   Gives each texture a small, stable id.
+ *   @details There are only a handful of textures (one per atlas page
+ *            when the atlas is in use) so a linear search is fastest.
+ *   @return  The texture's id.
+ */
+uint32_t RenderQueue::textureId(const ASGE::Texture2D* texture)
+{
+  auto found = std::find(textures.begin(), textures.end(), texture);
+  if (found != textures.end())
+  {
+    return static_cast<uint32_t>(found - textures.begin());
+  }
+
+  textures.push_back(texture);
+  return static_cast<uint32_t>(textures.size() - 1);
+}
+
+/**
+ *   @brief   Sorts the queue by key.
+ *   @details A stable LSD radix sort over the three bytes used by the
+ *            keys. Passes where every key shares the same byte are
+ *            skipped, which is the common case for the texture's high
+ *            byte and, with a single atlas page, the texture's low byte.
+ *            Each pass scatters between the queue and a scratch buffer
+ *            taken from the frame arena.
+ *   @return  void
+ */
+void RenderQueue::sort(FrameArena& arena)
+{
+  const int passes = 3;
+  std::vector<Entry, ArenaAllocator<Entry>> scratch(
+    entries.size(), ArenaAllocator<Entry>(arena));
+  Entry* source = entries.data();
+  Entry* sorted = scratch.data();
+
+  for (int pass = 0; pass < passes; pass++)
+  {
+    int shift = pass * 8;
+    size_t counts[256] = {};
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+      counts[(source[i].key >> shift) & 0xFF]++;
+    }
+
+    if (entries.empty() ||
+        counts[(source[0].key >> shift) & 0xFF] == entries.size())
+    {
+      continue;
+    }
+
+    size_t offset = 0;
+    for (auto& count : counts)
+    {
+      size_t bucket = count;
+      count = offset;
+      offset += bucket;
+    }
+
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+      sorted[counts[(source[i].key >> shift) & 0xFF]++] = source[i];
+    }
+    std::swap(source, sorted);
+  }
+
+  if (source != entries.data())
+  {
+    std::copy(source, source + entries.size(), entries.data());
+  }
+}
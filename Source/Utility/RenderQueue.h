@@ -0,0 +1,112 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include <Engine/Renderer.h>
+#include <Engine/Sprite.h>
+
+#include "FrameArena.h"
+
+/**
+ *  Draw layers, drawn from first to last.
+ */
+enum class RenderLayer : uint8_t
+{
+  SHIPS = 0,
+  PLAYER = 1,
+  SHOTS = 2
+};
+
+/**
+ *  Collects the sprites to draw this frame and submits them in one pass.
+ *  Sprites outside the viewport are culled as they are added. The rest
+ *  are radix sorted by layer and then texture, so that with the renderer
+ *  in SpriteSortMode::DEFERRED each layer is drawn with the fewest
+ *  possible texture changes and batches. The queue holds pointers, so
+ *  systems that draw many items by moving one shared sprite, such as
+ *  particles, draw themselves instead.
+ */
+class RenderQueue
+{
+ public:
+  RenderQueue() = default;
+  ~RenderQueue() = default;
+
+  /**
+   *  Sets the area sprites must overlap to be drawn.
+   *  @param [in] width The width of the viewport
+   *  @param [in] height The height of the viewport
+   */
+  void viewport(float width, float height);
+
+  /**
+   *  Reserves space so that filling the queue never allocates.
+   *  @param [in] sprites The most sprites expected in a frame
+   */
+  void reserve(size_t sprites);
+
+  /**
+   *  Empties the queue and resets the frame's stats.
+   */
+  void begin();
+
+  /**
+   *  Queues a sprite, unless it is entirely off screen.
+   *  The sprite must stay alive until the queue is submitted.
+   *  @param [in] sprite The sprite to draw
+   *  @param [in] layer The layer to draw it on
+   */
+  void add(const ASGE::Sprite& sprite, RenderLayer layer);
+
+  /**
+   *  Sorts the queued sprites and renders them.
+   *  @param [in] renderer The renderer to draw with
+   *  @param [in] arena The frame's arena, used while sorting
+   */
+  void submit(ASGE::Renderer* renderer, FrameArena& arena);
+
+  /**
+   *  The sprites drawn by the last submit.
+   *  @return the number of sprites drawn
+   */
+  int submitted() const;
+
+  /**
+   *  The sprites left out this frame for being off screen.
+   *  @return the number of sprites culled
+   */
+  int culled() const;
+
+  /**
+   *  The texture changes in the last submit, after sorting.
+   *  @return the number of texture changes
+   */
+  int textureChanges() const;
+
+  /**
+   *  The texture changes the last submit would have made unsorted, in
+   *  the order its sprites were added.
+   *  @return the number of texture changes without sorting
+   */
+  int unsortedTextureChanges() const;
+
+ private:
+  struct Entry
+  {
+    uint32_t key;
+    const ASGE::Sprite* sprite;
+  };
+
+  uint32_t textureId(const ASGE::Texture2D* texture);
+  void sort(FrameArena& arena);
+
+  float view_width = 0;
+  float view_height = 0;
+
+  std::vector<Entry> entries;
+  std::vector<const ASGE::Texture2D*> textures;
+
+  int culled_count = 0;
+  int texture_changes = 0;
+  int unsorted_changes = 0;
+};
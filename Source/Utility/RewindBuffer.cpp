@@ -0,0 +1,422 @@
+#include "RewindBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+// zero bytes in a row that end a run of literal bytes
+const size_t MIN_ZERO_RUN = 4;
+
+/**
+ *   @brief   Appends a number using 7 bits per byte.
+ *   @details The top bit of each byte is set if another byte follows,
+ *            so the short runs that make up most frames take one byte.
+ *   @return  The position after the number.
+ */
+static char* putLength(char* out, size_t length)
+{
+  while (length >= 0x80)
+  {
+    *out++ = static_cast<char>((length & 0x7F) | 0x80);
+    length >>= 7;
+  }
+  *out++ = static_cast<char>(length);
+  return out;
+}
+
+static size_t getLength(const char*& in)
+{
+  size_t length = 0;
+  int shift = 0;
+  unsigned char byte = 0;
+  do
+  {
+    byte = static_cast<unsigned char>(*in++);
+    length |= static_cast<size_t>(byte & 0x7F) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  return length;
+}
+
+static uint64_t loadWord(const char* data)
+{
+  uint64_t word = 0;
+  std::memcpy(&word, data, sizeof(word));
+  return word;
+}
+
+/**
+ *   @brief   Checks whether any byte of a word is zero.
+ *   @return  True if a byte is zero.
+ */
+static bool hasZeroByte(uint64_t word)
+{
+  const uint64_t ones = 0x0101010101010101ULL;
+  const uint64_t highs = 0x8080808080808080ULL;
+  return ((word - ones) & ~word & highs) != 0;
+}
+
+/**
+ *   @brief   Finds the end of a run of zero bytes.
+ *   @return  The position of the first non-zero byte, or size.
+ */
+static size_t zeroRunEnd(const char* data, size_t i, size_t size)
+{
+  while (i + sizeof(uint64_t) <= size && loadWord(data + i) == 0)
+  {
+    i += sizeof(uint64_t);
+  }
+  while (i < size && data[i] == 0)
+  {
+    i++;
+  }
+  return i;
+}
+
+/**
+ *   @brief   Finds the end of a run of literal bytes.
+ *   @details A literal run only ends at MIN_ZERO_RUN zeros in a row, as
+ *            stopping at fewer would cost more in lengths than it saves.
+ *            Words with no zero byte cannot hold the start of such a run,
+ *            so they are skipped whole.
+ *   @return  The position of the first zero run, or size.
+ */
+static size_t literalRunEnd(const char* data, size_t i, size_t size)
+{
+  while (i + MIN_ZERO_RUN <= size)
+  {
+    if (i + sizeof(uint64_t) <= size && !hasZeroByte(loadWord(data + i)))
+    {
+      i += sizeof(uint64_t);
+      continue;
+    }
+
+    if (std::all_of(
+          data + i, data + i + MIN_ZERO_RUN, [](char c) { return c == 0; }))
+    {
+      return i;
+    }
+    i++;
+  }
+  return size;
+}
+
+/**
+ *   @brief   Allocates the ring and the space to encode frames in.
+ *   @details Nothing is allocated after this. An encoded frame takes at
+ *            most twice its size, as every run of literal bytes but the
+ *            last is paid for by the zeros before it.
+ *   @return  void
+ */
+void RewindBuffer::reserve(size_t bytes,
+                           double seconds,
+                           size_t frames,
+                           size_t frame_size,
+                           int keyframe_interval)
+{
+  limit = seconds;
+  ring.resize(bytes);
+  entries.resize(std::max<size_t>(frames, 1));
+  changes.resize(frame_size);
+  scratch.resize(frame_size * 2 + 32);
+  key_image.resize(frame_size);
+  interval = std::max(keyframe_interval, 1);
+  clear();
+}
+
+/**
+ *   @brief   Adds a frame to the history.
+ *   @details The frame is encoded before room is made for it, as its
+ *            encoded size is not known until then. Making room can drop
+ *            the keyframe it was encoded against, in which case it is
+ *            encoded again as a keyframe itself. A frame too large for
+ *            the ring would leave a gap in the history, so the history
+ *            is cleared instead. Once the frame is in, the oldest blocks
+ *            are dropped for as long as what is left still covers the
+ *            length of time kept.
+ *   @return  False if the frame is too large to keep.
+ */
+bool RewindBuffer::record(const char* frame, size_t size, double duration)
+{
+  if (size > key_image.size())
+  {
+    clear();
+    return false;
+  }
+
+  if (count == entries.size())
+  {
+    dropOldest();
+  }
+
+  bool as_keyframe = !key_valid || since_keyframe >= interval;
+  size_t length = encode(frame, size, as_keyframe);
+  if (!place(length))
+  {
+    clear();
+    return false;
+  }
+
+  if (!as_keyframe && !key_valid)
+  {
+    as_keyframe = true;
+    length = encode(frame, size, as_keyframe);
+    if (!place(length))
+    {
+      clear();
+      return false;
+    }
+  }
+
+  size_t number = first + count;
+  record_entry& added = entry(number);
+  added.offset = head;
+  added.size = length;
+  added.frame_size = size;
+  added.keyframe = as_keyframe ? number : key_number;
+  added.duration = duration;
+  std::copy_n(scratch.data(), length, ring.data() + head);
+  head += length;
+  used += length;
+  span += duration;
+  count++;
+
+  if (as_keyframe)
+  {
+    std::copy_n(frame, size, key_image.data());
+    key_size = size;
+    key_number = number;
+    key_valid = true;
+    since_keyframe = 0;
+  }
+  since_keyframe++;
+
+  while (count > 0 && span - oldestBlock() >= limit)
+  {
+    dropOldest();
+  }
+  return true;
+}
+
+/**
+ *   @brief   Steps back through the history.
+ *   @details Only the frame stepped to is decoded, the newer ones are
+ *            just forgotten. Stepping back into an older block first
+ *            decodes that block's keyframe, so this is at most two passes
+ *            over a frame however far it steps. The frames' space in the
+ *            ring is reused by the next frame recorded, which is always a
+ *            keyframe, as the newest keyframe may have just been removed.
+ *   @return  The time stepped back, 0 if no frame was removed.
+ */
+double RewindBuffer::pop(double seconds, std::vector<char>& frame)
+{
+  size_t number = first + count;
+  size_t freed = 0;
+  double stepped = 0;
+  while (number > first && stepped + entry(number - 1).duration <= seconds)
+  {
+    number--;
+    freed += entry(number).size;
+    stepped += entry(number).duration;
+  }
+
+  if (number == first + count)
+  {
+    return 0;
+  }
+
+  const record_entry& reached = entry(number);
+  if (reached.keyframe != number &&
+      (!key_valid || key_number != reached.keyframe))
+  {
+    const record_entry& keyframe = entry(reached.keyframe);
+    decode(keyframe, false, key_image.data());
+    key_size = keyframe.frame_size;
+    key_number = reached.keyframe;
+    key_valid = true;
+  }
+
+  frame.resize(reached.frame_size);
+  decode(reached, reached.keyframe != number, frame.data());
+  head = reached.offset;
+  used -= freed;
+  span -= stepped;
+  count = number - first;
+
+  key_valid = key_valid && key_number < first + count;
+  since_keyframe = interval;
+  return stepped;
+}
+
+void RewindBuffer::clear()
+{
+  first += count;
+  count = 0;
+  head = 0;
+  used = 0;
+  span = 0;
+  key_valid = false;
+  since_keyframe = 0;
+}
+
+size_t RewindBuffer::frames() const
+{
+  return count;
+}
+
+size_t RewindBuffer::bytes() const
+{
+  return used;
+}
+
+double RewindBuffer::seconds() const
+{
+  return span;
+}
+
+/**
+ *   @brief   Encodes a frame into the scratch space.
+ *   @details The frame is first XORed with the last keyframe, or with
+ *            nothing if it is a keyframe, into a buffer of changes. Bytes
+ *            past the end of the keyframe are copied as they are. The
+ *            changes are then stored as pairs of a run of zeros, which is
+ *            only a length, and a run of literal bytes. Both passes work
+ *            eight bytes at a time where they can, so a keyframe full of
+ *            literals costs little more than a frame that barely changed.
+ *   @return  The size of the encoded frame.
+ */
+size_t RewindBuffer::encode(const char* frame, size_t size, bool as_keyframe)
+{
+  const char* reference = key_image.data();
+  size_t reference_size = as_keyframe ? 0 : std::min(size, key_size);
+  char* delta = changes.data();
+  for (size_t i = 0; i < reference_size; i++)
+  {
+    delta[i] = static_cast<char>(frame[i] ^ reference[i]);
+  }
+  std::copy(frame + reference_size, frame + size, delta + reference_size);
+
+  char* out = scratch.data();
+  size_t i = 0;
+  while (i < size)
+  {
+    size_t literal_start = zeroRunEnd(delta, i, size);
+    size_t literal_end = literalRunEnd(delta, literal_start, size);
+    out = putLength(out, literal_start - i);
+    out = putLength(out, literal_end - literal_start);
+    out = std::copy(delta + literal_start, delta + literal_end, out);
+    i = literal_end;
+  }
+  return static_cast<size_t>(out - scratch.data());
+}
+
+/**
+ *   @brief   Decodes a frame from the ring.
+ *   @details Expands the runs back into the changes, then XORs them
+ *            with the held keyframe image if the frame was stored
+ *            against it.
+ *   @return  void
+ */
+void RewindBuffer::decode(const record_entry& stored,
+                          bool against_keyframe,
+                          char* frame) const
+{
+  const char* in = ring.data() + stored.offset;
+  const char* end = in + stored.size;
+  size_t i = 0;
+  while (in < end)
+  {
+    size_t zeros = getLength(in);
+    size_t literals = getLength(in);
+    std::fill_n(frame + i, zeros, 0);
+    std::copy_n(in, literals, frame + i + zeros);
+    in += literals;
+    i += zeros + literals;
+  }
+
+  const char* reference = key_image.data();
+  size_t reference_size =
+    against_keyframe ? std::min(stored.frame_size, key_size) : 0;
+  for (size_t j = 0; j < reference_size; j++)
+  {
+    frame[j] = static_cast<char>(frame[j] ^ reference[j]);
+  }
+}
+
+/**
+ *   @brief   Makes room for an encoded frame at the head of the ring.
+ *   @details Frames are stored whole, in the order they were recorded.
+ *            If the frame does not fit before the end of the ring, the
+ *            head goes back to the start, dropping every frame past it
+ *            as those are the oldest. Frames still in the way are then
+ *            dropped, oldest first.
+ *   @return  False if the frame is larger than the ring.
+ */
+bool RewindBuffer::place(size_t size)
+{
+  if (size > ring.size())
+  {
+    return false;
+  }
+
+  if (head + size > ring.size())
+  {
+    while (count > 0 && entry(first).offset >= head)
+    {
+      dropOldest();
+    }
+    head = 0;
+  }
+
+  while (count > 0 && entry(first).offset >= head &&
+         entry(first).offset < head + size)
+  {
+    dropOldest();
+  }
+  return true;
+}
+
+/**
+ *   @brief   Drops the oldest keyframe and the frames stored against it.
+ *   @details The history always starts with a keyframe, so every frame
+ *            kept can be decoded.
+ *   @return  void
+ */
+void RewindBuffer::dropOldest()
+{
+  do
+  {
+    used -= entry(first).size;
+    span -= entry(first).duration;
+    first++;
+    count--;
+  } while (count > 0 && entry(first).keyframe != first);
+
+  key_valid = key_valid && key_number >= first;
+}
+
+/**
+ *   @brief   Works out how long the oldest block covers.
+ *   @return  The seconds covered by the oldest keyframe and the frames
+ *            stored against it.
+ */
+double RewindBuffer::oldestBlock() const
+{
+  double duration = 0;
+  size_t number = first;
+  do
+  {
+    duration += entry(number).duration;
+    number++;
+  } while (number < first + count && entry(number).keyframe != number);
+  return duration;
+}
+
+RewindBuffer::record_entry& RewindBuffer::entry(size_t number)
+{
+  return entries[number % entries.size()];
+}
+
+const RewindBuffer::record_entry& RewindBuffer::entry(size_t number) const
+{
+  return entries[number % entries.size()];
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ *  A history of recent frames that can be stepped back through.
+ *  Frames are blocks of bytes, such as encoded game states, that change
+ *  little from one frame to the next. Every keyframe_interval frames a
+ *  keyframe is stored whole; the frames in between are stored as their
+ *  XOR against the last keyframe, so anything unchanged since then is a
+ *  run of zeros. Both are run length encoded into one ring of bytes.
+ *  Recording and stepping back each take one or two linear passes over
+ *  a frame, whether or not a keyframe is involved, so neither causes a
+ *  spike. Each frame records how long it was on screen, so the history
+ *  is kept to a length of time rather than a number of frames, however
+ *  fast frames come. When the history grows too long or the ring fills,
+ *  the oldest keyframe is dropped along with the frames that depend on it.
+ */
+class RewindBuffer
+{
+ public:
+  RewindBuffer() = default;
+  ~RewindBuffer() = default;
+
+  /**
+   *  Allocates the ring and the space to encode frames in.
+   *  @param [in] bytes The size of the ring
+   *  @param [in] seconds The length of time to keep
+   *  @param [in] frames The most frames to keep
+   *  @param [in] frame_size The largest frame that will be recorded
+   *  @param [in] keyframe_interval The frames from one keyframe to the next
+   */
+  void reserve(size_t bytes,
+               double seconds,
+               size_t frames,
+               size_t frame_size,
+               int keyframe_interval);
+
+  /**
+   *  Adds a frame to the history.
+   *  @param [in] frame The frame's bytes
+   *  @param [in] size The size of the frame
+   *  @param [in] duration The seconds since the last frame recorded
+   *  @return false if the frame is too large to keep
+   */
+  bool record(const char* frame, size_t size, double duration);
+
+  /**
+   *  Steps back through the history.
+   *  Removes the newest frames for as long as the time they cover fits
+   *  in seconds, and decodes the last one removed.
+   *  @param [in] seconds The most time to step back
+   *  @param [out] frame Replaced with the bytes of the frame stepped to
+   *  @return the time stepped back, 0 if no frame was removed
+   */
+  double pop(double seconds, std::vector<char>& frame);
+
+  /**
+   *  Forgets every frame.
+   */
+  void clear();
+
+  size_t frames() const;
+  size_t bytes() const;
+  double seconds() const;
+
+ private:
+  struct record_entry
+  {
+    size_t offset = 0;     /**< Where the encoded frame is in the ring. */
+    size_t size = 0;       /**< The size of the encoded frame. */
+    size_t frame_size = 0; /**< The size of the frame itself. */
+    size_t keyframe = 0;   /**< The number of the frame it is XORed with. */
+    double duration = 0;   /**< The seconds since the frame before it. */
+  };
+
+  size_t encode(const char* frame, size_t size, bool as_keyframe);
+  void
+  decode(const record_entry& stored, bool against_keyframe, char* frame) const;
+  bool place(size_t size);
+  void dropOldest();
+  double oldestBlock() const;
+  record_entry& entry(size_t number);
+  const record_entry& entry(size_t number) const;
+
+  std::vector<char> ring;
+  std::vector<record_entry> entries;
+  size_t first = 0; /**< The number of the oldest frame kept. */
+  size_t count = 0;
+  size_t head = 0; /**< Where the next encoded frame goes in the ring. */
+  size_t used = 0;
+  double span = 0;  /**< The seconds covered by the frames kept. */
+  double limit = 0; /**< The most seconds to keep. */
+
+  std::vector<char> changes;
+  std::vector<char> scratch;
+  std::vector<char> key_image;
+  size_t key_size = 0;
+  size_t key_number = 0;
+  bool key_valid = false;
+  int interval = 1;
+  int since_keyframe = 0;
+};
@@ -0,0 +1,242 @@
+#include "Script.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+Script& Script::wait(float seconds)
+{
+  return add(ScriptOp::WAIT, seconds, seconds);
+}
+
+Script& Script::waitRandom(float min, float max)
+{
+  return add(ScriptOp::WAIT_RANDOM, min, max);
+}
+
+Script& Script::dive()
+{
+  return add(ScriptOp::DIVE);
+}
+
+Script& Script::fire()
+{
+  return add(ScriptOp::FIRE);
+}
+
+Script& Script::rejoin()
+{
+  return add(ScriptOp::REJOIN);
+}
+
+Script& Script::loop()
+{
+  return add(ScriptOp::LOOP);
+}
+
+const std::vector<script_step>& Script::steps() const
+{
+  return step_list;
+}
+
+Script& Script::add(ScriptOp op, float min, float max)
+{
+  script_step step;
+  step.op = op;
+  step.min = min;
+  step.max = max;
+  step_list.push_back(step);
+  return *this;
+}
+
+void ScriptRunner::reserve(size_t capacity)
+{
+  states.reserve(capacity);
+  timers.reserve(capacity);
+}
+
+void ScriptRunner::actions(std::function<bool(int)> alive,
+                           std::function<float(int)> dive,
+                           std::function<void(int)> fire)
+{
+  alive_action = std::move(alive);
+  dive_action = std::move(dive);
+  fire_action = std::move(fire);
+}
+
+bool ScriptRunner::start(const Script& script, int ship)
+{
+  script_state* state = states.acquire();
+  if (!state)
+  {
+    return false;
+  }
+
+  state->script = &script;
+  state->ship = ship;
+  state->step = 0;
+  state->dive_end = 0;
+  state->timer = timers.after(0, [this, state]() { resume(state); });
+  return true;
+}
+
+void ScriptRunner::update(float delta_time)
+{
+  timers.advance(delta_time);
+}
+
+void ScriptRunner::clear()
+{
+  timers.clear();
+  states.releaseAll();
+}
+
+size_t ScriptRunner::size() const
+{
+  return states.size();
+}
+
+/**
+ *   @brief   Runs a script until it waits or ends.
+ *   @details Waits too short to last a tick are skipped. A script whose
+ *            ship has died ends here, as does one that loops all the
+ *            way round without waiting, which would otherwise never
+ *            give control back.
+ *   @return  void
+ */
+void ScriptRunner::resume(script_state* state)
+{
+  const std::vector<script_step>& steps = state->script->steps();
+  for (size_t ran = 0; ran <= steps.size(); ran++)
+  {
+    if (state->step >= steps.size() || !alive_action(state->ship))
+    {
+      break;
+    }
+
+    const script_step& step = steps[state->step++];
+    switch (step.op)
+    {
+      case ScriptOp::WAIT:
+      case ScriptOp::WAIT_RANDOM:
+      {
+        float blend = step.op == ScriptOp::WAIT_RANDOM
+                        ? static_cast<float>(std::rand()) / RAND_MAX
+                        : 0;
+        if (sleep(state, step.min + (step.max - step.min) * blend))
+        {
+          return;
+        }
+        break;
+      }
+
+      case ScriptOp::DIVE:
+        state->dive_end = timers.time() + dive_action(state->ship);
+        break;
+
+      case ScriptOp::FIRE:
+        fire_action(state->ship);
+        break;
+
+      case ScriptOp::REJOIN:
+        if (sleep(state, state->dive_end - timers.time()))
+        {
+          return;
+        }
+        break;
+
+      case ScriptOp::LOOP:
+        state->step = 0;
+        break;
+    }
+  }
+
+  states.release(state);
+}
+
+/**
+ *   @brief   Puts a script to sleep.
+ *   @return  False if the time is too short to sleep for.
+ */
+bool ScriptRunner::sleep(script_state* state, double seconds)
+{
+  if (TimerWheel::ticks(seconds) == 0)
+  {
+    return false;
+  }
+
+  state->timer = timers.after(seconds, [this, state]() { resume(state); });
+  return true;
+}
+
+/**
+ *   @brief   Saves the running scripts.
+ *   @details Every running script is asleep on a timer, so the scripts
+ *            are found by walking the pool for states with an active
+ *            timer. Scripts missing from the list are left out.
+ *   @return  The number of scripts saved.
+ */
+uint32_t ScriptRunner::save(running_script* saved,
+                            size_t capacity,
+                            std::initializer_list<const Script*> scripts) const
+{
+  uint32_t count = 0;
+  for (size_t i = 0; i < states.span() && count < capacity; i++)
+  {
+    const script_state& state = states[i];
+    auto found = std::find(scripts.begin(), scripts.end(), state.script);
+    if (!timers.active(state.timer) || found == scripts.end())
+    {
+      continue;
+    }
+
+    running_script& script = saved[count++];
+    script.script = static_cast<uint32_t>(found - scripts.begin());
+    script.ship = state.ship;
+    script.step = static_cast<uint32_t>(state.step);
+    script.wake = timers.remaining(state.timer);
+    script.dive_end = state.dive_end;
+  }
+  return count;
+}
+
+/**
+ *   @brief   Restarts saved scripts.
+ *   @details The clock has already been set, so each script is put back
+ *            to sleep for the ticks it had left and wakes on the same
+ *            tick it would have before. A saved script may come from a
+ *            file, so one naming an unknown script or ship, or a step
+ *            past the end of its script, is skipped. A step just past
+ *            the last is kept, as the script ends when it wakes.
+ *   @return  void
+ */
+void ScriptRunner::restore(const running_script* saved,
+                           size_t count,
+                           int ship_count,
+                           std::initializer_list<const Script*> scripts)
+{
+  states.releaseAll();
+  for (size_t i = 0; i < count; i++)
+  {
+    const running_script& script = saved[i];
+    if (script.script >= scripts.size() || script.ship < 0 ||
+        script.ship >= ship_count ||
+        script.step > scripts.begin()[script.script]->steps().size())
+    {
+      continue;
+    }
+
+    script_state* state = states.acquire();
+    if (!state)
+    {
+      return;
+    }
+
+    state->script = scripts.begin()[script.script];
+    state->ship = script.ship;
+    state->step = script.step;
+    state->dive_end = script.dive_end;
+    state->timer = timers.after(script.wake * TIMER_TICK,
+                                [this, state]() { resume(state); });
+  }
+}
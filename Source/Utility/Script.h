@@ -0,0 +1,222 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+#include "ObjectPool.h"
+#include "TimerWheel.h"
+
+enum class ScriptOp : uint8_t
+{
+  WAIT,
+  WAIT_RANDOM,
+  DIVE,
+  FIRE,
+  REJOIN,
+  LOOP
+};
+
+struct script_step
+{
+  ScriptOp op = ScriptOp::WAIT;
+  float min = 0;
+  float max = 0;
+};
+
+/**
+ *  A ship's behaviour, written as a list of steps.
+ *  Scripts are built by chaining steps together, e.g.
+ *  script.wait(2).dive().fire().wait(0.3f).fire().rejoin().loop()
+ *  A script that loops must wait somewhere in its body.
+ */
+class Script
+{
+ public:
+  Script() = default;
+  ~Script() = default;
+
+  /**
+   *  Pauses the script. Pauses shorter than half a timer tick are
+   *  skipped.
+   *  @param [in] seconds How long to pause for
+   */
+  Script& wait(float seconds);
+
+  /**
+   *  Pauses the script for a random time.
+   *  @param [in] min The shortest pause in seconds
+   *  @param [in] max The longest pause in seconds
+   */
+  Script& waitRandom(float min, float max);
+
+  /**
+   *  Sends the ship out of the formation on a dive.
+   */
+  Script& dive();
+
+  /**
+   *  Fires a shot from the ship.
+   */
+  Script& fire();
+
+  /**
+   *  Pauses the script until the ship's dive has finished.
+   */
+  Script& rejoin();
+
+  /**
+   *  Starts the script again from its first step.
+   */
+  Script& loop();
+
+  const std::vector<script_step>& steps() const;
+
+ private:
+  Script& add(ScriptOp op, float min = 0, float max = 0);
+
+  std::vector<script_step> step_list;
+};
+
+/**
+ *  A saved running script. Scripts are saved by their place in a list of
+ *  scripts given when saving and restoring, as pointers do not survive
+ *  being written to disk.
+ */
+struct running_script
+{
+  uint32_t script = 0;
+  int32_t ship = 0;
+  uint32_t step = 0;
+  uint32_t wake = 0; /**< Ticks until the script resumes. */
+  double dive_end = 0;
+};
+
+/**
+ *  A saved copy of every running script and the clock they sleep on.
+ */
+template <size_t N>
+struct script_snapshot
+{
+  timer_clock clock;
+  uint32_t count = 0;
+  running_script scripts[N];
+};
+
+/**
+ *  Runs many scripts at once, one per ship.
+ *  A running script is just its place in the script and a few values,
+ *  kept in a fixed size pool, so starting and finishing scripts never
+ *  allocates. Scripts run until they reach a wait, then sleep on a
+ *  TimerWheel. Each update only touches the scripts that are due, so
+ *  sleeping scripts cost nothing until they resume.
+ *  What dive and fire do is left to the game, given through actions().
+ */
+class ScriptRunner
+{
+ public:
+  ScriptRunner() = default;
+  ~ScriptRunner() = default;
+
+  /**
+   *  Allocates room for a number of scripts running at once.
+   *  @param [in] capacity The most running scripts
+   */
+  void reserve(size_t capacity);
+
+  /**
+   *  Sets what the scripts' steps do to the game.
+   *  @param [in] alive Whether a ship is still alive. A script ends as
+   *                    soon as it resumes and its ship is gone
+   *  @param [in] dive Sends a ship on a dive, returning how long the
+   *                   dive lasts in seconds
+   *  @param [in] fire Fires a shot from a ship
+   */
+  void actions(std::function<bool(int)> alive,
+               std::function<float(int)> dive,
+               std::function<void(int)> fire);
+
+  /**
+   *  Starts a script for a ship. It first runs on the next timer tick.
+   *  The script must stay alive while it is running.
+   *  @param [in] script The script to run
+   *  @param [in] ship The ship it controls
+   *  @return false if there is no room for another script
+   */
+  bool start(const Script& script, int ship);
+
+  /**
+   *  Moves the clock on and resumes every script that is due.
+   *  @param [in] delta_time The time passed in seconds
+   */
+  void update(float delta_time);
+
+  /**
+   *  Stops every script at once.
+   */
+  void clear();
+
+  size_t size() const;
+
+  /**
+   *  Copies every running script into a snapshot.
+   *  @param [out] snapshot The snapshot to fill
+   *  @param [in] scripts Every script that may be running
+   */
+  template <size_t N>
+  void save(script_snapshot<N>& snapshot,
+            std::initializer_list<const Script*> scripts) const
+  {
+    snapshot.clock = timers.clock();
+    snapshot.count = save(snapshot.scripts, N, scripts);
+  }
+
+  /**
+   *  Replaces the running scripts with those in a snapshot.
+   *  Scripts for ships the game does not have, or past the end of their
+   *  script, are dropped.
+   *  @param [in] snapshot The snapshot to copy from
+   *  @param [in] ship_count The number of ships the scripts can run on
+   *  @param [in] scripts The same scripts, in the same order, as saved
+   */
+  template <size_t N>
+  void restore(const script_snapshot<N>& snapshot,
+               int ship_count,
+               std::initializer_list<const Script*> scripts)
+  {
+    timers.clock(snapshot.clock);
+    restore(snapshot.scripts,
+            std::min(static_cast<size_t>(snapshot.count), N),
+            ship_count,
+            scripts);
+  }
+
+ private:
+  struct script_state
+  {
+    const Script* script = nullptr;
+    int ship = 0;
+    size_t step = 0;
+    double dive_end = 0;
+    timer_handle timer;
+  };
+
+  void resume(script_state* state);
+  bool sleep(script_state* state, double seconds);
+  uint32_t save(running_script* saved,
+                size_t capacity,
+                std::initializer_list<const Script*> scripts) const;
+  void restore(const running_script* saved,
+               size_t count,
+               int ship_count,
+               std::initializer_list<const Script*> scripts);
+
+  ObjectPool<script_state> states;
+  TimerWheel timers;
+
+  std::function<bool(int)> alive_action;
+  std::function<float(int)> dive_action;
+  std::function<void(int)> fire_action;
+};
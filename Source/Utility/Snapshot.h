@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ *  A saved copy of a set of moving points, such as projectiles or boids.
+ *  Sized for the most points the owner can hold, so it can be copied
+ *  as a plain block of memory. Only the first count entries are used.
+ */
+template <size_t N>
+struct motion_snapshot
+{
+  uint32_t count = 0;
+  float xs[N];
+  float ys[N];
+  float velocity_xs[N];
+  float velocity_ys[N];
+};
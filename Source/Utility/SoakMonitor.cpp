@@ -0,0 +1,50 @@
+#include "SoakMonitor.h"
+
+void SoakMonitor::spawned(int ships)
+{
+  interval_ships += static_cast<uint64_t>(ships);
+}
+
+/**
+ *   @brief   Records a frame.
+ *   @details Once an interval's worth of play has been recorded, its
+ *            spawn rate and mean frame time become the new report and
+ *            the next interval starts from zero.
+ *   @return  True if a new report is ready.
+ */
+bool SoakMonitor::frame(double delta_time, double work_ms)
+{
+  total_time += delta_time;
+  interval_time += delta_time;
+  interval_work_ms += work_ms;
+  interval_frames++;
+  if (interval_time < SOAK_REPORT_INTERVAL)
+  {
+    return false;
+  }
+
+  last.interval++;
+  last.ships_per_minute =
+    static_cast<double>(interval_ships) * 60 / interval_time;
+  last.frame_ms = interval_work_ms / static_cast<double>(interval_frames);
+  if (last.interval == 1)
+  {
+    last.first_frame_ms = last.frame_ms;
+  }
+
+  interval_time = 0;
+  interval_work_ms = 0;
+  interval_frames = 0;
+  interval_ships = 0;
+  return true;
+}
+
+const soak_report& SoakMonitor::report() const
+{
+  return last;
+}
+
+double SoakMonitor::elapsed() const
+{
+  return total_time;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+
+// how much play each soak report covers, in seconds
+const double SOAK_REPORT_INTERVAL = 60;
+
+/**
+ *  A soak report, covering one interval of play.
+ */
+struct soak_report
+{
+  int interval = 0; /**< How many intervals have been reported. */
+  double ships_per_minute = 0;
+  double frame_ms = 0;       /**< The mean time spent on a frame. */
+  double first_frame_ms = 0; /**< The first interval's mean. */
+};
+
+/**
+ *  Measures an unattended endless run.
+ *  Counts the ships spawned and times the work each frame does, and
+ *  reports them once per interval of play. Every report carries the
+ *  first interval's frame time, so a frame time that creeps up over
+ *  hours of play shows as the gap between the two.
+ */
+class SoakMonitor
+{
+ public:
+  SoakMonitor() = default;
+  ~SoakMonitor() = default;
+
+  /**
+   *  Counts the ships of a wave that has just been placed.
+   *  @param [in] ships The number of ships spawned
+   */
+  void spawned(int ships);
+
+  /**
+   *  Records a frame.
+   *  @param [in] delta_time The time the frame covered, in seconds
+   *  @param [in] work_ms The time spent updating and rendering it
+   *  @return true if an interval has just ended and report() is new
+   */
+  bool frame(double delta_time, double work_ms);
+
+  const soak_report& report() const;
+
+  /**
+   *  The total play time recorded, in seconds.
+   *  @return the time soaked
+   */
+  double elapsed() const;
+
+ private:
+  soak_report last;
+  double total_time = 0;
+  double interval_time = 0;
+  double interval_work_ms = 0;
+  uint64_t interval_frames = 0;
+  uint64_t interval_ships = 0;
+};
@@ -0,0 +1,66 @@
+#include "SpatialGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+void SpatialGrid::resize(float width, float height, float size)
+{
+  cell_size = size;
+  columns = std::max(1, static_cast<int>(std::ceil(width / size)));
+  rows = std::max(1, static_cast<int>(std::ceil(height / size)));
+  cell_start.assign(static_cast<size_t>(columns * rows) + 1, 0);
+}
+
+void SpatialGrid::reserve(size_t points)
+{
+  item_cells.resize(std::max(item_cells.size(), points));
+  items.resize(std::max(items.size(), points));
+}
+
+/**
+ *   @brief   Counting sorts the points by the cell they are in.
+ *   @details One pass finds and counts each point's cell, the counts are
+ *            turned into each cell's starting offset, and a second pass
+ *            places the points. The storage only grows, so once it has
+ *            seen the largest set of points it never allocates again.
+ *   @return  void
+ */
+void SpatialGrid::build(const float* xs, const float* ys, size_t count)
+{
+  reserve(count);
+
+  std::fill(cell_start.begin(), cell_start.end(), 0);
+  for (size_t i = 0; i < count; i++)
+  {
+    auto cell = static_cast<uint32_t>(cellY(ys[i]) * columns + cellX(xs[i]));
+    item_cells[i] = cell;
+    cell_start[cell + 1]++;
+  }
+
+  for (size_t cell = 1; cell < cell_start.size(); cell++)
+  {
+    cell_start[cell] += cell_start[cell - 1];
+  }
+
+  // each cell's start is used as its insert position, which leaves it at
+  // the cell's end, so the starts are shifted back up a cell afterwards
+  for (size_t i = 0; i < count; i++)
+  {
+    items[cell_start[item_cells[i]]++] = static_cast<uint32_t>(i);
+  }
+  for (size_t cell = cell_start.size() - 1; cell > 0; cell--)
+  {
+    cell_start[cell] = cell_start[cell - 1];
+  }
+  cell_start[0] = 0;
+}
+
+int SpatialGrid::cellX(float x) const
+{
+  return std::clamp(static_cast<int>(x / cell_size), 0, columns - 1);
+}
+
+int SpatialGrid::cellY(float y) const
+{
+  return std::clamp(static_cast<int>(y / cell_size), 0, rows - 1);
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Rect.h"
+
+/**
+ *  A uniform grid over a set of points, rebuilt from scratch each frame.
+ *  build() counting sorts the points by cell, so every cell's points end
+ *  up contiguous and a query only visits the cells its area overlaps.
+ *  Points outside the grid are clamped into its edge cells.
+ */
+class SpatialGrid
+{
+ public:
+  SpatialGrid() = default;
+  ~SpatialGrid() = default;
+
+  /**
+   *  Sets the area covered by the grid.
+   *  @param [in] width The width of the area
+   *  @param [in] height The height of the area
+   *  @param [in] cell_size The width and height of each cell
+   */
+  void resize(float width, float height, float cell_size);
+
+  /**
+   *  Allocates room to sort a number of points without growing.
+   *  @param [in] points The most points expected
+   */
+  void reserve(size_t points);
+
+  /**
+   *  Sorts a set of points into the grid.
+   *  @param [in] xs The x position of each point
+   *  @param [in] ys The y position of each point
+   *  @param [in] count The number of points
+   */
+  void build(const float* xs, const float* ys, size_t count);
+
+  /**
+   *  Calls visit with the index of every point in the cells that overlap
+   *  an area. Points near the area but outside it may also be visited.
+   *  @param [in] area The area to search
+   *  @param [in] visit Called with each point's index, returns false to
+   *                    stop the search
+   */
+  template <typename Visit>
+  void query(const rect& area, Visit&& visit) const
+  {
+    int first_column = cellX(area.x);
+    int last_column = cellX(area.x + area.length);
+    int first_row = cellY(area.y);
+    int last_row = cellY(area.y + area.height);
+
+    for (int row = first_row; row <= last_row; row++)
+    {
+      for (int column = first_column; column <= last_column; column++)
+      {
+        auto cell = static_cast<size_t>(row * columns + column);
+        for (uint32_t i = cell_start[cell]; i < cell_start[cell + 1]; i++)
+        {
+          if (!visit(items[i]))
+          {
+            return;
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   *  Calls visit with the index of every point in the cells around a
+   *  position, nearest cells first. The position's own cell is visited
+   *  first, then the ring of cells around it, and so on outwards, so a
+   *  search that only needs a few nearby points can stop early.
+   *  @param [in] x The position to search around
+   *  @param [in] y The position to search around
+   *  @param [in] rings How many rings of cells to visit around its cell
+   *  @param [in] visit Called with each point's index, returns false to
+   *                    stop the search
+   */
+  template <typename Visit>
+  void queryNearest(float x, float y, int rings, Visit&& visit) const
+  {
+    int centre_column = cellX(x);
+    int centre_row = cellY(y);
+    for (int ring = 0; ring <= rings; ring++)
+    {
+      for (int row = centre_row - ring; row <= centre_row + ring; row++)
+      {
+        if (row < 0 || row >= rows)
+        {
+          continue;
+        }
+
+        // the ring's top and bottom rows are whole, the rest only have
+        // their first and last cells
+        bool edge = row == centre_row - ring || row == centre_row + ring;
+        int step = edge || ring == 0 ? 1 : ring * 2;
+        for (int column = centre_column - ring; column <= centre_column + ring;
+             column += step)
+        {
+          if (column < 0 || column >= columns)
+          {
+            continue;
+          }
+
+          auto cell = static_cast<size_t>(row * columns + column);
+          for (uint32_t i = cell_start[cell]; i < cell_start[cell + 1]; i++)
+          {
+            if (!visit(items[i]))
+            {
+              return;
+            }
+          }
+        }
+      }
+    }
+  }
+
+ private:
+  int cellX(float x) const;
+  int cellY(float y) const;
+
+  float cell_size = 1;
+  int columns = 1;
+  int rows = 1;
+  std::vector<uint32_t> cell_start = std::vector<uint32_t>(2, 0);
+  std::vector<uint32_t> item_cells;
+  std::vector<uint32_t> items;
+};
@@ -0,0 +1,78 @@
+#include "SpriteAtlas.h"
+#include "AssetData.h"
+#include "Hash.h"
+
+#include <algorithm>
+#include <cstring>
+
+/**
+ *   @brief   Loads and validates the atlas index.
+ *   @details The index is small and read once at startup, so it is
+ *            copied out of the archive rather than used in place.
+ *   @return  True if the index was found and is valid.
+ */
+bool SpriteAtlas::load(const AssetArchive* archive)
+{
+  pages.clear();
+  regions.clear();
+
+  AssetData index;
+  if (!index.load(archive, ATLAS_INDEX_FILE) ||
+      index.size() < sizeof(AtlasHeader))
+  {
+    return false;
+  }
+
+  AtlasHeader header;
+  std::memcpy(&header, index.data(), sizeof(header));
+  if (std::memcmp(header.magic, ATLAS_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != ATLAS_VERSION ||
+      index.size() <
+        sizeof(header) + header.region_count * sizeof(AtlasRegion))
+  {
+    return false;
+  }
+
+  regions.resize(header.region_count);
+  std::memcpy(regions.data(),
+              index.data() + sizeof(header),
+              regions.size() * sizeof(AtlasRegion));
+
+  for (uint32_t i = 0; i < header.page_count; i++)
+  {
+    pages.push_back(atlasPageFile(i));
+  }
+
+  for (const auto& region : regions)
+  {
+    if (region.page >= header.page_count)
+    {
+      regions.clear();
+      pages.clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+const AtlasRegion*
+SpriteAtlas::find(const std::string& texture_file_name) const
+{
+  uint64_t hash = hashPath(texture_file_name);
+  auto region = std::lower_bound(
+    regions.begin(),
+    regions.end(),
+    hash,
+    [](const AtlasRegion& lhs, uint64_t rhs) { return lhs.path_hash < rhs; });
+
+  if (region == regions.end() || region->path_hash != hash)
+  {
+    return nullptr;
+  }
+  return &*region;
+}
+
+const std::string& SpriteAtlas::pageFile(uint32_t page) const
+{
+  return pages[page];
+}
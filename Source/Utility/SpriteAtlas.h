@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class AssetArchive;
+
+const char ATLAS_MAGIC[4] = { 'S', 'I', 'A', 'T' };
+const uint32_t ATLAS_VERSION = 1;
+const char ATLAS_INDEX_FILE[] = "atlas/sprites.idx";
+
+/**
+ *  The header at the start of the atlas index.
+ *  It is followed by region_count AtlasRegion records sorted by hash.
+ */
+struct AtlasHeader
+{
+  char magic[4] = { 0, 0, 0, 0 };
+  uint32_t version = 0;
+  uint32_t page_count = 0;
+  uint32_t region_count = 0;
+};
+
+/**
+ *  Where a source image was packed, in pixels on its atlas page.
+ */
+struct AtlasRegion
+{
+  uint64_t path_hash = 0;
+  uint32_t page = 0;
+  uint32_t x = 0;
+  uint32_t y = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t reserved = 0;
+};
+
+static_assert(sizeof(AtlasHeader) == 16, "atlas header must be packed");
+static_assert(sizeof(AtlasRegion) == 32, "atlas region must be packed");
+
+/**
+ *  The sprite atlas generated at build time by the AtlasPacker tool.
+ *  Every image in GameData/images is packed onto as few textures as
+ *  possible, so sprites of different types share a texture and can be
+ *  drawn in a single batch. Sprites still refer to their original image
+ *  path; the atlas translates that into a page and a source rectangle.
+ *  @see Tools/AtlasPacker
+ */
+class SpriteAtlas
+{
+ public:
+  SpriteAtlas() = default;
+  ~SpriteAtlas() = default;
+
+  /**
+   *  Loads the atlas index.
+   *  @param [in] archive The packed archive to read from (optional)
+   *  @return true if an atlas is available
+   */
+  bool load(const AssetArchive* archive);
+
+  /**
+   *  Finds the region an image was packed into.
+   *  @param [in] texture_file_name The original image path
+   *  @return the region, or nullptr if the image is not in the atlas
+   */
+  const AtlasRegion* find(const std::string& texture_file_name) const;
+
+  /**
+   *  The texture holding one of the atlas' pages.
+   *  @param [in] page The page number, from an AtlasRegion
+   *  @return the path of the page's texture
+   */
+  const std::string& pageFile(uint32_t page) const;
+
+ private:
+  std::vector<std::string> pages;
+  std::vector<AtlasRegion> regions;
+};
+
+/**
+ *  The name of an atlas page's texture, relative to GameData.
+ *  Shared with the packer so both agree on where pages live.
+ */
+inline std::string atlasPageFile(uint32_t page)
+{
+  return "atlas/sprites" + std::to_string(page) + ".tga";
+}
@@ -0,0 +1,57 @@
+#include "TextCache.h"
+#include <cstring>
+#include <utility>
+
+TextCache::Id
+TextCache::add(const std::string& text, int x, int y, size_t capacity)
+{
+  Line line;
+  line.text.reserve(capacity);
+  line.text = text;
+  line.x = x;
+  line.y = y;
+  lines.push_back(std::move(line));
+  return lines.size() - 1;
+}
+
+TextCache::Id TextCache::add(const std::string& text,
+                             int x,
+                             int y,
+                             float scale,
+                             const ASGE::Colour& colour,
+                             size_t capacity)
+{
+  Id id = add(text, x, y, capacity);
+  lines[id].scale = scale;
+  lines[id].colour = colour;
+  lines[id].default_colour = false;
+  return id;
+}
+
+/**
+ *   @brief   Updates a line of text.
+ *   @details The new text is compared before anything is rebuilt, so
+ *            calling this with unchanged text is cheap.
+ *   @return  void
+ */
+void TextCache::set(Id id, const char* text)
+{
+  std::string& line = lines[id].text;
+  if (std::strcmp(line.c_str(), text) != 0)
+  {
+    line.assign(text);
+  }
+}
+
+void TextCache::render(ASGE::Renderer* renderer, Id id) const
+{
+  const Line& line = lines[id];
+  if (line.default_colour)
+  {
+    renderer->renderText(line.text, line.x, line.y);
+  }
+  else
+  {
+    renderer->renderText(line.text, line.x, line.y, line.scale, line.colour);
+  }
+}
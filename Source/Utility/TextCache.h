@@ -0,0 +1,79 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include <Engine/Colours.h>
+#include <Engine/Renderer.h>
+
+/**
+ *  Holds the game's text, laid out once and redrawn every frame.
+ *  Static text such as menus is built when it is added and never touched
+ *  again. Dynamic text is only rebuilt when set() is given new contents,
+ *  and reuses its existing buffer when it does.
+ *  ASGE takes the string it draws by value, so only lines that fit the
+ *  standard library's small string buffer (15 characters for libstdc++)
+ *  draw without allocating. That holds for the gameplay HUD, the score
+ *  up to eight digits and "No rewind", which gameplay frames check with
+ *  NoAllocationScope. Menu, mode and end screen lines are longer and are
+ *  copied on every draw; those screens are static, so FrameScheduler
+ *  sleeps between their frames rather than redrawing them flat out.
+ */
+class TextCache
+{
+ public:
+  using Id = size_t;
+
+  TextCache() = default;
+  ~TextCache() = default;
+
+  /**
+   *  Adds a line of text drawn in the renderer's default text colour.
+   *  @param [in] text The text to draw
+   *  @param [in] x The position of the text
+   *  @param [in] y The position of the text
+   *  @param [in] capacity Room to reserve for later, longer text
+   *  @return the id used to update and render the line
+   */
+  Id add(const std::string& text, int x, int y, size_t capacity = 0);
+
+  /**
+   *  Adds a line of text drawn in the given colour and scale.
+   *  @see add
+   */
+  Id add(const std::string& text,
+         int x,
+         int y,
+         float scale,
+         const ASGE::Colour& colour,
+         size_t capacity = 0);
+
+  /**
+   *  Changes a line's text.
+   *  Does nothing if the text is unchanged. Otherwise the text is copied
+   *  into the line's existing buffer, which only allocates if it has to
+   *  grow beyond the capacity the line was added with.
+   *  @param [in] id The line to update
+   *  @param [in] text The new text
+   */
+  void set(Id id, const char* text);
+
+  /**
+   *  Draws a line of text.
+   *  @param [in] renderer The renderer to draw with
+   *  @param [in] id The line to draw
+   */
+  void render(ASGE::Renderer* renderer, Id id) const;
+
+ private:
+  struct Line
+  {
+    std::string text;
+    int x = 0;
+    int y = 0;
+    float scale = 1;
+    ASGE::Colour colour = ASGE::COLOURS::WHITE;
+    bool default_colour = true;
+  };
+
+  std::vector<Line> lines;
+};
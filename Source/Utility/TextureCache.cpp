@@ -0,0 +1,205 @@
+#include "TextureCache.h"
+#include "AssetData.h"
+#include "Hash.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include <Engine/FileIO.h>
+
+// ASGE bundles stb_image for its own texture loading and exports it, so
+// textures are decoded here by exactly the same decoder the engine uses
+extern "C"
+{
+  unsigned char* stbi_load_from_memory(const unsigned char* buffer,
+                                       int len,
+                                       int* x,
+                                       int* y,
+                                       int* channels_in_file,
+                                       int desired_channels);
+  void stbi_image_free(void* retval_from_stbi_load);
+}
+
+/**
+ *   @brief   Writes RGBA pixels as an uncompressed TGA.
+ *   @details The image is stored top to bottom as BGRA, which is the
+ *            layout stb_image can read back with a straight copy. The
+ *            file is written through ASGE's FileIO, so it goes into the
+ *            write directory that its file system searches first.
+ *   @return  True if the file was written.
+ */
+static bool writeTga(const std::string& path,
+                     const unsigned char* pixels,
+                     int width,
+                     int height)
+{
+  unsigned char header[18] = {};
+  header[2] = 2; // uncompressed true colour
+  header[12] = static_cast<unsigned char>(width & 0xFF);
+  header[13] = static_cast<unsigned char>((width >> 8) & 0xFF);
+  header[14] = static_cast<unsigned char>(height & 0xFF);
+  header[15] = static_cast<unsigned char>((height >> 8) & 0xFF);
+  header[16] = 32;   // bits per pixel
+  header[17] = 0x28; // 8 alpha bits, top left origin
+
+  size_t pixel_count = static_cast<size_t>(width) * height;
+  std::vector<unsigned char> image(sizeof(header) + pixel_count * 4);
+  std::copy(header, header + sizeof(header), image.begin());
+  unsigned char* bgra = image.data() + sizeof(header);
+  for (size_t i = 0; i < pixel_count; i++)
+  {
+    bgra[i * 4 + 0] = pixels[i * 4 + 2];
+    bgra[i * 4 + 1] = pixels[i * 4 + 1];
+    bgra[i * 4 + 2] = pixels[i * 4 + 0];
+    bgra[i * 4 + 3] = pixels[i * 4 + 3];
+  }
+
+  ASGE::FILEIO::IOBuffer buffer;
+  buffer.append(reinterpret_cast<const char*>(image.data()), image.size());
+
+  ASGE::FILEIO::File file;
+  if (!file.open(path, ASGE::FILEIO::File::IOMode::WRITE))
+  {
+    return false;
+  }
+
+  bool written = file.write(buffer) == buffer.length;
+  return file.close() && written;
+}
+
+/**
+ *   @brief   Checks whether a file can be found by ASGE's FileIO.
+ *   @return  True if the file exists.
+ */
+static bool fileExists(const std::string& path)
+{
+  ASGE::FILEIO::File file;
+  if (!file.open(path))
+  {
+    return false;
+  }
+  file.close();
+  return true;
+}
+
+void TextureCache::useArchive(const AssetArchive* asset_archive)
+{
+  archive = asset_archive;
+}
+
+void TextureCache::directory(const std::string& cache_dir)
+{
+  dir = cache_dir;
+}
+
+/**
+ *   @brief   Loads a texture's cached copy into a sprite.
+ *   @details Textures are looked up once per run; sprites sharing a
+ *            texture reuse the first result. A texture only counts as a
+ *            hit or a miss once its cached copy has actually loaded.
+ *   @return  False if the texture should be loaded from its source.
+ */
+bool TextureCache::load(ASGE::Sprite* sprite,
+                        const std::string& texture_file_name)
+{
+  auto found = resolved.find(texture_file_name);
+  if (found == resolved.end())
+  {
+    found =
+      resolved.emplace(texture_file_name, cacheTexture(texture_file_name))
+        .first;
+  }
+
+  cache_entry& entry = found->second;
+  if (entry.file.empty())
+  {
+    return false;
+  }
+
+  if (!sprite->loadTexture(entry.file))
+  {
+    ASGE::FILEIO::deleteFile(entry.file);
+    entry.file.clear();
+    return false;
+  }
+
+  if (!entry.counted)
+  {
+    entry.counted = true;
+    entry.decoded ? cache_misses++ : cache_hits++;
+  }
+  return true;
+}
+
+int TextureCache::hits() const
+{
+  return cache_hits;
+}
+
+int TextureCache::misses() const
+{
+  return cache_misses;
+}
+
+/**
+ *   @brief   Finds or creates the cache entry for a texture.
+ *   @details The source is found in the archive if there is one, where
+ *            its hash was stored when packed, or read through ASGE's
+ *            FileIO and hashed otherwise. A cache file with that hash is
+ *            used as is; if there isn't one the source is decoded and
+ *            written out. Any failure leaves the entry without a file,
+ *            so the source is loaded directly.
+ *   @return  The texture's cache entry.
+ */
+TextureCache::cache_entry
+TextureCache::cacheTexture(const std::string& texture_file_name)
+{
+  cache_entry entry;
+  AssetData source;
+  if (!source.load(archive, texture_file_name))
+  {
+    return entry;
+  }
+
+  char key[32];
+  std::snprintf(key,
+                sizeof(key),
+                "%016llx",
+                static_cast<unsigned long long>(source.hash()));
+  std::string cache_file = dir + "/" + key + ".tga";
+
+  if (fileExists(cache_file))
+  {
+    entry.file = cache_file;
+    return entry;
+  }
+
+  int width = 0;
+  int height = 0;
+  int channels = 0;
+  unsigned char* pixels = stbi_load_from_memory(source.data(),
+                                                static_cast<int>(source.size()),
+                                                &width,
+                                                &height,
+                                                &channels,
+                                                4);
+  if (!pixels)
+  {
+    return entry;
+  }
+
+  ASGE::FILEIO::createDir(dir);
+  bool written = writeTga(cache_file, pixels, width, height);
+  stbi_image_free(pixels);
+
+  if (!written)
+  {
+    ASGE::FILEIO::deleteFile(cache_file);
+    return entry;
+  }
+
+  entry.file = cache_file;
+  entry.decoded = true;
+  return entry;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+
+#include <Engine/Sprite.h>
+
+class AssetArchive;
+
+/**
+ *  Caches decoded textures on disk so PNGs are only decoded once.
+ *  The first time a texture is seen its PNG is decoded and written to the
+ *  cache folder as an uncompressed 32 bit TGA, named after a hash of the
+ *  PNG's contents. Later runs find the TGA and hand that to ASGE instead,
+ *  whose decoder only has to copy the pixels. Textures in the packed
+ *  archive were hashed when it was built, so a warm start never reads
+ *  their PNGs; loose files in GameData are read and hashed each run.
+ *  The cache folder is in ASGE's write directory, which its file system
+ *  searches first, so Sprite::loadTexture finds the TGAs by name.
+ *  Because entries are keyed by contents, editing an image can never
+ *  return stale pixels; the old entry simply stops being used.
+ */
+class TextureCache
+{
+ public:
+  TextureCache() = default;
+  ~TextureCache() = default;
+
+  /**
+   *  Reads source images from a packed archive when possible.
+   *  @param [in] asset_archive The archive, must outlive the cache
+   */
+  void useArchive(const AssetArchive* asset_archive);
+
+  /**
+   *  Sets the folder that decoded textures are written to.
+   *  @param [in] cache_dir The folder, in ASGE's write directory, to use
+   */
+  void directory(const std::string& cache_dir);
+
+  /**
+   *  Loads a texture's cached copy into a sprite.
+   *  Decodes and stores the texture if it is not yet in the cache. The
+   *  lookup is remembered, so every sprite sharing a texture only pays
+   *  for it once. A cached copy that fails to load is deleted, so it is
+   *  written again on the next run.
+   *  @param [in] sprite The sprite to load the texture into
+   *  @param [in] texture_file_name The source image, i.e. a PNG
+   *  @return false if the texture should be loaded from its source
+   */
+  bool load(ASGE::Sprite* sprite, const std::string& texture_file_name);
+
+  int hits() const;
+  int misses() const;
+
+ private:
+  /**
+   *  Where a texture's cached copy is, and how it got there.
+   */
+  struct cache_entry
+  {
+    std::string file;     /**< The cached copy, empty if there is none. */
+    bool decoded = false; /**< Whether it was decoded this run. */
+    bool counted = false; /**< Whether it has been loaded yet. */
+  };
+
+  cache_entry cacheTexture(const std::string& texture_file_name);
+
+  const AssetArchive* archive = nullptr;
+  std::string dir = "cache/textures";
+  std::unordered_map<std::string, cache_entry> resolved;
+  int cache_hits = 0;
+  int cache_misses = 0;
+};
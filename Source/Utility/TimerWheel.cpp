@@ -0,0 +1,267 @@
+#include "TimerWheel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+const int LEVELS = 4;
+const int SLOT_BITS = 6;
+const uint32_t SLOTS = 1u << SLOT_BITS;
+const uint32_t SLOT_MASK = SLOTS - 1;
+// the longest delay the wheel can hold, in ticks
+const uint32_t MAX_DELAY = (1u << (SLOT_BITS * LEVELS)) - 1;
+// timers due on the tick being run, after the slot they were in
+const uint32_t EXPIRING = SLOTS * LEVELS;
+const uint32_t NONE = UINT32_MAX;
+
+void TimerWheel::reserve(size_t capacity)
+{
+  nodes.clear();
+  nodes.resize(capacity);
+  heads.assign(EXPIRING + 1, NONE);
+  free_list = NONE;
+  for (size_t i = capacity; i > 0; i--)
+  {
+    auto index = static_cast<uint32_t>(i - 1);
+    nodes[index].list = NONE;
+    nodes[index].next = free_list;
+    free_list = index;
+  }
+  pending = 0;
+}
+
+timer_handle TimerWheel::after(double seconds, std::function<void()> callback)
+{
+  if (free_list == NONE)
+  {
+    return timer_handle{};
+  }
+
+  uint32_t index = free_list;
+  node& timer = nodes[index];
+  free_list = timer.next;
+
+  uint32_t delay = std::min(std::max(ticks(seconds), 1u), MAX_DELAY);
+  timer.callback = std::move(callback);
+  timer.expires = now + delay - 1;
+  file(index);
+  pending++;
+  return timer_handle{ index, timer.generation };
+}
+
+bool TimerWheel::cancel(timer_handle timer)
+{
+  if (!active(timer))
+  {
+    return false;
+  }
+
+  unlink(timer.index);
+  release(timer.index);
+  return true;
+}
+
+bool TimerWheel::active(timer_handle timer) const
+{
+  return timer.index < nodes.size() &&
+         nodes[timer.index].generation == timer.generation &&
+         nodes[timer.index].list != NONE;
+}
+
+/**
+ *   @brief   Works out how many ticks are left before a timer fires.
+ *   @details A timer fires on the tick its expiry falls on, which is
+ *            the tick after the clock reads its expiry.
+ *   @return  The ticks left, or 0 if the timer is not active.
+ */
+uint32_t TimerWheel::remaining(timer_handle timer) const
+{
+  if (!active(timer))
+  {
+    return 0;
+  }
+  return nodes[timer.index].expires + 1 - now;
+}
+
+void TimerWheel::advance(double delta_time)
+{
+  carry += delta_time;
+  while (carry >= TIMER_TICK)
+  {
+    carry -= TIMER_TICK;
+    tick();
+  }
+}
+
+void TimerWheel::clear()
+{
+  std::fill(heads.begin(), heads.end(), NONE);
+  free_list = NONE;
+  for (size_t i = nodes.size(); i > 0; i--)
+  {
+    auto index = static_cast<uint32_t>(i - 1);
+    if (nodes[index].list != NONE)
+    {
+      nodes[index].callback = nullptr;
+      nodes[index].generation++;
+      nodes[index].list = NONE;
+    }
+    nodes[index].next = free_list;
+    free_list = index;
+  }
+  pending = 0;
+}
+
+double TimerWheel::time() const
+{
+  return now * TIMER_TICK;
+}
+
+timer_clock TimerWheel::clock() const
+{
+  return timer_clock{ now, carry };
+}
+
+/**
+ *   @brief   Sets the clock.
+ *   @details Timers are filed by their absolute expiry, so the wheel is
+ *            emptied first rather than left holding timers filed
+ *            against a different time.
+ *   @return  void
+ */
+void TimerWheel::clock(const timer_clock& saved)
+{
+  clear();
+  now = saved.now;
+  carry = saved.carry;
+}
+
+uint32_t TimerWheel::ticks(double seconds)
+{
+  long count = std::lround(seconds / TIMER_TICK);
+  return static_cast<uint32_t>(std::clamp(count, 0L, long{ UINT32_MAX }));
+}
+
+size_t TimerWheel::size() const
+{
+  return pending;
+}
+
+/**
+ *   @brief   Runs one tick of the clock.
+ *   @details When the first level completes a turn, the next slot of
+ *            each level above that has also completed a turn is re-filed
+ *            into the levels below. The tick's slot is then moved to the
+ *            expiring list and its timers are fired one at a time, so a
+ *            callback may safely schedule or cancel any timer.
+ *   @return  void
+ */
+void TimerWheel::tick()
+{
+  uint32_t slot = now & SLOT_MASK;
+  if (slot == 0)
+  {
+    for (int level = 1; level < LEVELS; level++)
+    {
+      uint32_t upper_slot = (now >> (SLOT_BITS * level)) & SLOT_MASK;
+      cascade(level, upper_slot);
+      if (upper_slot != 0)
+      {
+        break;
+      }
+    }
+  }
+
+  heads[EXPIRING] = heads[slot];
+  heads[slot] = NONE;
+  for (uint32_t i = heads[EXPIRING]; i != NONE; i = nodes[i].next)
+  {
+    nodes[i].list = EXPIRING;
+  }
+  now++;
+
+  while (heads[EXPIRING] != NONE)
+  {
+    uint32_t index = heads[EXPIRING];
+    unlink(index);
+    std::function<void()> callback = std::move(nodes[index].callback);
+    release(index);
+    callback();
+  }
+}
+
+/**
+ *   @brief   Files a timer in the slot its expiry falls in.
+ *   @details The level is picked by how far away the expiry is, and the
+ *            slot within the level by the matching bits of the expiry.
+ *   @return  void
+ */
+void TimerWheel::file(uint32_t index)
+{
+  uint32_t expires = nodes[index].expires;
+  uint32_t delay = expires - now;
+
+  int level = 0;
+  while (level < LEVELS - 1 && delay >= (1u << (SLOT_BITS * (level + 1))))
+  {
+    level++;
+  }
+
+  uint32_t slot = (expires >> (SLOT_BITS * level)) & SLOT_MASK;
+  link(index, static_cast<uint32_t>(level) * SLOTS + slot);
+}
+
+void TimerWheel::cascade(int level, uint32_t slot)
+{
+  uint32_t list = static_cast<uint32_t>(level) * SLOTS + slot;
+  uint32_t index = heads[list];
+  heads[list] = NONE;
+  while (index != NONE)
+  {
+    uint32_t next = nodes[index].next;
+    file(index);
+    index = next;
+  }
+}
+
+void TimerWheel::link(uint32_t index, uint32_t list)
+{
+  node& timer = nodes[index];
+  timer.list = list;
+  timer.prev = NONE;
+  timer.next = heads[list];
+  if (timer.next != NONE)
+  {
+    nodes[timer.next].prev = index;
+  }
+  heads[list] = index;
+}
+
+void TimerWheel::unlink(uint32_t index)
+{
+  node& timer = nodes[index];
+  if (timer.prev != NONE)
+  {
+    nodes[timer.prev].next = timer.next;
+  }
+  else
+  {
+    heads[timer.list] = timer.next;
+  }
+
+  if (timer.next != NONE)
+  {
+    nodes[timer.next].prev = timer.prev;
+  }
+}
+
+void TimerWheel::release(uint32_t index)
+{
+  node& timer = nodes[index];
+  timer.callback = nullptr;
+  timer.generation++;
+  timer.list = NONE;
+  timer.next = free_list;
+  free_list = index;
+  pending--;
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// the length of one tick of the timer clock, in seconds
+const double TIMER_TICK = 1.0 / 120;
+
+/**
+ *  Identifies a scheduled timer so it can be cancelled.
+ *  Handles to timers that have fired or been cancelled are safe to use,
+ *  they are simply no longer active.
+ */
+struct timer_handle
+{
+  uint32_t index = UINT32_MAX;
+  uint32_t generation = 0;
+};
+
+/**
+ *  A wheel's clock, saved so a restored wheel carries on from the same
+ *  tick with the same fraction of a tick left over.
+ */
+struct timer_clock
+{
+  uint32_t now = 0;
+  double carry = 0;
+};
+
+/**
+ *  Runs callbacks at future times on a fixed step clock.
+ *  A hierarchical timing wheel: four levels of 64 slots, each slot of a
+ *  level spanning a whole turn of the level below. Timers are filed in
+ *  the slot their expiry falls in, and when a level completes a turn
+ *  the next slot of the level above is re-filed into it. Scheduling and
+ *  cancelling are constant time, and a tick only touches the timers
+ *  that expire on it, plus an occasional re-file, however many timers
+ *  are pending. Timers live in a fixed size pool of intrusive list
+ *  nodes, so scheduling never allocates as long as each callback fits
+ *  std::function's small buffer (a pointer and an int, for example).
+ */
+class TimerWheel
+{
+ public:
+  TimerWheel() = default;
+  ~TimerWheel() = default;
+
+  /**
+   *  Allocates room for timers. Cancels any pending timers.
+   *  @param [in] capacity The most timers pending at once
+   */
+  void reserve(size_t capacity);
+
+  /**
+   *  Schedules a callback.
+   *  Delays are rounded to the nearest tick, and always last at least
+   *  one tick. Delays longer than the wheel spans are shortened to fit.
+   *  @param [in] seconds How long to wait
+   *  @param [in] callback What to run
+   *  @return the timer's handle, inactive if the pool is full
+   */
+  timer_handle after(double seconds, std::function<void()> callback);
+
+  /**
+   *  Stops a timer from firing.
+   *  @param [in] timer The timer to stop
+   *  @return false if the timer had already fired or been cancelled
+   */
+  bool cancel(timer_handle timer);
+
+  bool active(timer_handle timer) const;
+
+  /**
+   *  How long until a timer fires.
+   *  @param [in] timer The timer to check
+   *  @return the ticks left, or 0 if the timer is not active
+   */
+  uint32_t remaining(timer_handle timer) const;
+
+  /**
+   *  Moves the clock on, firing every timer that expires on the way.
+   *  Time left over from the last whole tick is carried to the next call.
+   *  @param [in] delta_time The time passed in seconds
+   */
+  void advance(double delta_time);
+
+  /**
+   *  Cancels every pending timer.
+   */
+  void clear();
+
+  /**
+   *  The time on the wheel's clock in seconds, in whole ticks.
+   */
+  double time() const;
+
+  timer_clock clock() const;
+
+  /**
+   *  Sets the clock, for example to a saved one. Cancels every pending
+   *  timer, so they should be scheduled again afterwards.
+   *  @param [in] saved The clock to carry on from
+   */
+  void clock(const timer_clock& saved);
+
+  /**
+   *  Converts a time to the number of whole ticks nearest to it.
+   */
+  static uint32_t ticks(double seconds);
+
+  size_t size() const;
+
+ private:
+  struct node
+  {
+    std::function<void()> callback;
+    uint32_t expires = 0;
+    uint32_t generation = 0;
+    uint32_t list = 0;
+    uint32_t prev = UINT32_MAX;
+    uint32_t next = UINT32_MAX;
+  };
+
+  void tick();
+  void file(uint32_t index);
+  void cascade(int level, uint32_t slot);
+  void link(uint32_t index, uint32_t list);
+  void unlink(uint32_t index);
+  void release(uint32_t index);
+
+  std::vector<node> nodes;
+  std::vector<uint32_t> heads;
+  uint32_t free_list = UINT32_MAX;
+  size_t pending = 0;
+
+  uint32_t now = 0;
+  double carry = 0;
+};
@@ -0,0 +1,46 @@
+#include "TrajectoryTable.h"
+
+#include <algorithm>
+#include <cmath>
+
+void TrajectoryTable::bake(const std::function<float(float)>& path,
+                           float min_x,
+                           float max_x,
+                           float step)
+{
+  auto count = static_cast<size_t>(std::ceil((max_x - min_x) / step)) + 1;
+  samples.resize(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    samples[i] = path(min_x + static_cast<float>(i) * step);
+  }
+
+  first_x = min_x;
+  inverse_step = 1 / step;
+  last_index = static_cast<float>(count - 1);
+}
+
+/**
+ *   @brief   Looks up a point on the path.
+ *   @details The x position is turned into a fractional index into the
+ *            samples, and the samples either side are blended. The last
+ *            sample's neighbour is itself, so the end of the range needs
+ *            no special case.
+ *   @return  The path's y position at x.
+ */
+float TrajectoryTable::at(float x) const
+{
+  float index = std::clamp((x - first_x) * inverse_step, 0.0f, last_index);
+  auto below = static_cast<size_t>(index);
+  size_t above = std::min(below + 1, samples.size() - 1);
+  float blend = index - static_cast<float>(below);
+  return samples[below] + (samples[above] - samples[below]) * blend;
+}
+
+void TrajectoryTable::evaluate(const float* xs, float* ys, size_t count) const
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    ys[i] = at(xs[i]);
+  }
+}
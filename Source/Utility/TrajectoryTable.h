@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/**
+ *  A path of the form y = f(x), sampled once into a table.
+ *  Looking a point up linearly interpolates between the two nearest
+ *  samples, which for the smooth curves the ships follow stays well
+ *  within a pixel of the real curve. x values outside the baked range
+ *  are clamped to its ends.
+ */
+class TrajectoryTable
+{
+ public:
+  TrajectoryTable() = default;
+  ~TrajectoryTable() = default;
+
+  /**
+   *  Samples a path over a range of x values.
+   *  @param [in] path The path, giving y for each x
+   *  @param [in] min_x The start of the range
+   *  @param [in] max_x The end of the range
+   *  @param [in] step The distance between samples
+   */
+  void bake(const std::function<float(float)>& path,
+            float min_x,
+            float max_x,
+            float step);
+
+  /**
+   *  Looks up a single point on the path.
+   *  @param [in] x The x position
+   *  @return the path's y position at x
+   */
+  float at(float x) const;
+
+  /**
+   *  Looks up a batch of points on the path.
+   *  @param [in] xs The x position of each point
+   *  @param [out] ys The path's y position at each x
+   *  @param [in] count The number of points
+   */
+  void evaluate(const float* xs, float* ys, size_t count) const;
+
+ private:
+  std::vector<float> samples;
+  float first_x = 0;
+  float inverse_step = 1;
+  float last_index = 0;
+};
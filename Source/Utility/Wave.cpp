@@ -0,0 +1,102 @@
+#include "Wave.h"
+
+#include <algorithm>
+#include <sstream>
+
+/**
+ *   @brief   Finds a texture in the wave's table, adding it if needed.
+ *   @return  The texture's index.
+ */
+static uint16_t textureIndex(wave_definition& wave, const std::string& file)
+{
+  auto found = std::find(wave.textures.begin(), wave.textures.end(), file);
+  if (found != wave.textures.end())
+  {
+    return static_cast<uint16_t>(found - wave.textures.begin());
+  }
+
+  wave.textures.push_back(file);
+  return static_cast<uint16_t>(wave.textures.size() - 1);
+}
+
+/**
+ *   @brief   Parses a wave's text into its prefab table.
+ *   @details Parsing stops at the first bad line, which is reported
+ *            along with its line number.
+ *   @return  An empty string if the wave parsed.
+ */
+std::string parseWave(const char* text, size_t size, wave_definition& wave)
+{
+  wave = wave_definition();
+  float origin_x = 0;
+  float origin_y = 0;
+  float spacing_x = 0;
+  float spacing_y = 0;
+
+  std::istringstream lines(std::string(text, size));
+  std::string line;
+  for (int line_number = 1; std::getline(lines, line); line_number++)
+  {
+    std::istringstream values(line.substr(0, line.find('#')));
+    std::string keyword;
+    if (!(values >> keyword))
+    {
+      continue;
+    }
+
+    bool valid = true;
+    if (keyword == "origin")
+    {
+      valid = static_cast<bool>(values >> origin_x >> origin_y);
+    }
+    else if (keyword == "spacing")
+    {
+      valid = static_cast<bool>(values >> spacing_x >> spacing_y);
+    }
+    else if (keyword == "size")
+    {
+      valid = static_cast<bool>(values >> wave.ship_width >> wave.ship_height);
+    }
+    else if (keyword == "speed")
+    {
+      valid = static_cast<bool>(values >> wave.speed);
+    }
+    else if (keyword == "row")
+    {
+      std::string image;
+      std::string cells;
+      valid = static_cast<bool>(values >> image >> cells);
+      for (size_t column = 0; valid && column < cells.size(); column++)
+      {
+        if (cells[column] != 'X')
+        {
+          continue;
+        }
+
+        ship_prefab ship;
+        ship.texture = textureIndex(wave, image);
+        ship.row = static_cast<uint16_t>(wave.rows);
+        ship.x = origin_x + static_cast<float>(column) * spacing_x;
+        ship.y = origin_y + static_cast<float>(wave.rows) * spacing_y;
+        wave.ships.push_back(ship);
+      }
+      wave.rows++;
+    }
+    else
+    {
+      return "line " + std::to_string(line_number) + ": unknown keyword " +
+             keyword;
+    }
+
+    if (!valid)
+    {
+      return "line " + std::to_string(line_number) + ": bad " + keyword;
+    }
+  }
+
+  if (wave.ships.empty())
+  {
+    return "no ships";
+  }
+  return "";
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ *  A ship placed by a wave's layout.
+ */
+struct ship_prefab
+{
+  uint16_t texture = 0; /**< Index into the wave's textures. */
+  uint16_t row = 0;     /**< The layout row the ship was placed in. */
+  float x = 0;
+  float y = 0;
+};
+
+/**
+ *  A wave of enemy ships, parsed from a text file in GameData/waves.
+ *  Each line holds a keyword followed by its values, and anything after
+ *  a # is a comment:
+ *
+ *    origin <x> <y>      where the first column of the first row sits
+ *    spacing <x> <y>     the distance between columns and rows
+ *    size <w> <h>        the size every ship is drawn at
+ *    speed <s>           how fast the wave moves
+ *    row <image> <cells> adds a row of ships using the image; each X in
+ *                        cells places a ship, any other character skips
+ *                        a column
+ *
+ *  Settings apply to the rows that follow them. Ships are stored in row
+ *  order, left to right.
+ */
+struct wave_definition
+{
+  std::vector<std::string> textures;
+  std::vector<ship_prefab> ships;
+  float ship_width = 50;
+  float ship_height = 50;
+  float speed = 50;
+  int rows = 0;
+};
+
+/**
+ *  Parses a wave file.
+ *  @param [in] text The contents of the file
+ *  @param [in] size The length of the contents
+ *  @param [out] wave The parsed wave
+ *  @return an empty string on success, otherwise what was wrong
+ */
+std::string parseWave(const char* text, size_t size, wave_definition& wave);
@@ -0,0 +1,134 @@
+#include "WaveLibrary.h"
+#include "AssetData.h"
+
+#include <sstream>
+
+#include <Engine/DebugPrinter.h>
+
+/**
+ *   @brief   Destructor.
+ *   @details Makes sure the loading worker is not left running.
+ */
+WaveLibrary::~WaveLibrary()
+{
+  stop();
+}
+
+/**
+ *   @brief   Loads the manifest and the first wave.
+ *   @details Every wave's storage is created up front so that the worker
+ *            never resizes anything the game might be reading.
+ *   @return  False if there is no wave to start the game with.
+ */
+bool WaveLibrary::load(const AssetArchive* asset_archive)
+{
+  stop();
+  archive = asset_archive;
+  files.clear();
+
+  AssetData manifest;
+  if (!manifest.load(archive, WAVE_MANIFEST_FILE))
+  {
+    ASGE::DebugPrinter{} << "Unable to read " << WAVE_MANIFEST_FILE
+                         << std::endl;
+    return false;
+  }
+
+  std::istringstream lines(
+    std::string(reinterpret_cast<const char*>(manifest.data()),
+                manifest.size()));
+  std::string line;
+  while (std::getline(lines, line))
+  {
+    std::istringstream values(line.substr(0, line.find('#')));
+    std::string file;
+    if (values >> file)
+    {
+      files.push_back("waves/" + file);
+    }
+  }
+
+  waves.assign(files.size(), wave_definition());
+  statuses.assign(files.size(), WaveStatus::LOADING);
+  if (files.empty())
+  {
+    return false;
+  }
+
+  statuses[0] = loadWave(0);
+  if (statuses[0] != WaveStatus::READY)
+  {
+    return false;
+  }
+
+  stopping = false;
+  worker = std::thread(&WaveLibrary::loadRemaining, this);
+  return true;
+}
+
+size_t WaveLibrary::count() const
+{
+  return files.size();
+}
+
+const wave_definition* WaveLibrary::wave(size_t index) const
+{
+  std::lock_guard<std::mutex> lock(status_mutex);
+  if (index >= statuses.size() || statuses[index] != WaveStatus::READY)
+  {
+    return nullptr;
+  }
+  return &waves[index];
+}
+
+bool WaveLibrary::loading(size_t index) const
+{
+  std::lock_guard<std::mutex> lock(status_mutex);
+  return index < statuses.size() && statuses[index] == WaveStatus::LOADING;
+}
+
+/**
+ *   @brief   Loads every wave after the first.
+ *   @details Runs on the worker thread. Each wave is parsed into its own
+ *            slot and only then marked as ready, so the game never sees
+ *            a partly parsed wave.
+ *   @return  void
+ */
+void WaveLibrary::loadRemaining()
+{
+  for (size_t i = 1; i < files.size() && !stopping; i++)
+  {
+    WaveStatus status = loadWave(i);
+    std::lock_guard<std::mutex> lock(status_mutex);
+    statuses[i] = status;
+  }
+}
+
+WaveLibrary::WaveStatus WaveLibrary::loadWave(size_t index)
+{
+  AssetData data;
+  if (!data.load(archive, files[index]))
+  {
+    ASGE::DebugPrinter{} << "Unable to read " << files[index] << std::endl;
+    return WaveStatus::FAILED;
+  }
+
+  std::string error =
+    parseWave(reinterpret_cast<const char*>(data.data()), data.size(),
+              waves[index]);
+  if (!error.empty())
+  {
+    ASGE::DebugPrinter{} << files[index] << ": " << error << std::endl;
+    return WaveStatus::FAILED;
+  }
+  return WaveStatus::READY;
+}
+
+void WaveLibrary::stop()
+{
+  stopping = true;
+  if (worker.joinable())
+  {
+    worker.join();
+  }
+}
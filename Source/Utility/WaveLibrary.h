@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Wave.h"
+
+class AssetArchive;
+
+/** Lists the wave files, one per line, in the order they are played. */
+const char* const WAVE_MANIFEST_FILE = "waves/waves.txt";
+
+/**
+ *  All of the game's waves, loaded from GameData/waves.
+ *  The first wave is needed before play starts so it is parsed straight
+ *  away. The rest are parsed in order on a worker thread while the game
+ *  runs, and each becomes available as soon as it is ready.
+ *  @see wave_definition
+ */
+class WaveLibrary
+{
+ public:
+  WaveLibrary() = default;
+
+  /**
+   *  Destructor. Stops and joins the loading worker.
+   */
+  ~WaveLibrary();
+
+  WaveLibrary(const WaveLibrary&) = delete;
+  WaveLibrary& operator=(const WaveLibrary&) = delete;
+
+  /**
+   *  Reads the wave manifest and the first wave, then starts loading the
+   *  remaining waves in the background.
+   *  @param [in] archive The packed archive to read from (optional)
+   *  @return false if the manifest or first wave could not be loaded
+   */
+  bool load(const AssetArchive* archive);
+
+  /**
+   *  @return the number of waves in the manifest
+   */
+  size_t count() const;
+
+  /**
+   *  Gets a wave, if it has been loaded.
+   *  @param [in] index The wave's position in the manifest
+   *  @return the wave, or nullptr if it is still loading or failed
+   */
+  const wave_definition* wave(size_t index) const;
+
+  /**
+   *  Is a wave still waiting to be loaded?
+   *  @param [in] index The wave's position in the manifest
+   *  @return true while the worker has not reached the wave
+   */
+  bool loading(size_t index) const;
+
+ private:
+  enum class WaveStatus
+  {
+    LOADING,
+    READY,
+    FAILED
+  };
+
+  void loadRemaining();
+  WaveStatus loadWave(size_t index);
+  void stop();
+
+  const AssetArchive* archive = nullptr;
+  std::vector<std::string> files;
+  std::vector<wave_definition> waves;
+  std::vector<WaveStatus> statuses;
+  mutable std::mutex status_mutex;
+
+  std::thread worker;
+  std::atomic<bool> stopping{ false };
+};
@@ -0,0 +1,130 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+/**
+ *   @brief   Destructor.
+ *   @details Makes sure no worker is left running.
+ */
+WorkerPool::~WorkerPool()
+{
+  stop();
+}
+
+void WorkerPool::start(size_t threads)
+{
+  stop();
+  stopping = false;
+  for (size_t i = 0; i < threads; i++)
+  {
+    workers.emplace_back(&WorkerPool::work, this, generation);
+  }
+}
+
+size_t WorkerPool::threads() const
+{
+  return workers.size() + 1;
+}
+
+/**
+ *   @brief   Runs a job across the workers and the calling thread.
+ *   @details The job is published under the lock and the workers woken.
+ *            The caller then takes chunks itself, so a job is never
+ *            slower than running it alone, and waits for the workers
+ *            to finish the chunks they took.
+ *   @return  void
+ */
+void WorkerPool::dispatch(size_t count, size_t chunk, JobFnc job, void* context)
+{
+  if (count == 0)
+  {
+    return;
+  }
+
+  job_fnc = job;
+  job_context = context;
+  job_count = count;
+  job_chunk = std::max<size_t>(chunk, 1);
+  next_index = 0;
+
+  if (workers.empty() || count <= job_chunk)
+  {
+    job_fnc(job_context, 0, count);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    generation++;
+    busy = workers.size();
+  }
+  wake.notify_all();
+
+  runChunks();
+
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [this]() { return busy == 0; });
+}
+
+/**
+ *   @brief   Takes chunks of the current job until none are left.
+ *   @return  void
+ */
+void WorkerPool::runChunks()
+{
+  for (;;)
+  {
+    size_t begin = next_index.fetch_add(job_chunk);
+    if (begin >= job_count)
+    {
+      return;
+    }
+    job_fnc(job_context, begin, std::min(begin + job_chunk, job_count));
+  }
+}
+
+/**
+ *   @brief   A worker's loop.
+ *   @details Sleeps until a new job is published, helps with it, and
+ *            reports back when it runs out of chunks. Starts from the
+ *            generation current when the pool started, so jobs
+ *            published before the thread first runs are not missed.
+ *   @return  void
+ */
+void WorkerPool::work(size_t seen)
+{
+  for (;;)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [&]() { return stopping || generation != seen; });
+      if (stopping)
+      {
+        return;
+      }
+      seen = generation;
+    }
+
+    runChunks();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (--busy == 0)
+    {
+      done.notify_one();
+    }
+  }
+}
+
+void WorkerPool::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+
+  for (auto& worker : workers)
+  {
+    worker.join();
+  }
+  workers.clear();
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ *  A fixed set of worker threads for splitting a loop across cores.
+ *  run() hands out a range of indices in small chunks, which the workers
+ *  and the calling thread take in turn until none are left, and returns
+ *  once every chunk is done. Jobs are passed as a function pointer and
+ *  context rather than a std::function, so running one never allocates.
+ *  A pool started with no workers runs everything on the calling thread.
+ */
+class WorkerPool
+{
+ public:
+  WorkerPool() = default;
+
+  /**
+   *  Destructor. Stops and joins the workers.
+   */
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  /**
+   *  Starts the workers.
+   *  @param [in] threads The number of workers, besides the caller
+   */
+  void start(size_t threads);
+
+  /**
+   *  Calls job(begin, end) over every index from 0 to count.
+   *  Each call covers at most chunk indices and may run on any thread,
+   *  so calls must not write to anything another chunk reads.
+   *  @param [in] count The number of indices
+   *  @param [in] chunk The most indices given to one call
+   *  @param [in] job Called with each range of indices
+   */
+  template <typename Job> void run(size_t count, size_t chunk, Job&& job)
+  {
+    using Callable = std::remove_reference_t<Job>;
+    dispatch(count,
+             chunk,
+             [](void* context, size_t begin, size_t end) {
+               (*static_cast<Callable*>(context))(begin, end);
+             },
+             &job);
+  }
+
+  /**
+   *  The number of threads a job is split across, including the caller.
+   *  @return the thread count
+   */
+  size_t threads() const;
+
+ private:
+  using JobFnc = void (*)(void*, size_t, size_t);
+
+  void dispatch(size_t count, size_t chunk, JobFnc job, void* context);
+  void work(size_t seen);
+  void runChunks();
+  void stop();
+
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+  bool stopping = false;
+  size_t generation = 0;
+  size_t busy = 0;
+
+  JobFnc job_fnc = nullptr;
+  void* job_context = nullptr;
+  size_t job_count = 0;
+  size_t job_chunk = 1;
+  std::atomic<size_t> next_index{ 0 };
+};
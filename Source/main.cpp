@@ -1,9 +1,43 @@
 #include "Game.h"
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include <string>
 
-int main()
+/**
+ *   @brief   Reads a soak run's length from the command line.
+ *   @details The whole argument must be a finite number of minutes, no
+ *            less than zero, so a typo is reported rather than ignored.
+ *   @return  True if the argument is a valid length.
+ */
+static bool parseMinutes(const char* text, double& minutes)
 {
+  char* end = nullptr;
+  minutes = std::strtod(text, &end);
+  return end != text && *end == '\0' && std::isfinite(minutes) &&
+         minutes >= 0;
+}
+
+int main(int argc, char* argv[])
+{
+  // --soak [minutes] plays endless mode unattended, for soak testing
+  bool soak = argc > 1 && std::string(argv[1]) == "--soak";
+  double soak_minutes = 0;
+  if (soak && (argc > 3 || (argc > 2 && !parseMinutes(argv[2], soak_minutes))))
+  {
+    std::cerr << "usage: " << argv[0] << " [--soak [minutes]]\n"
+              << "  minutes: how long to soak for, 0 or none to run until "
+                 "closed"
+              << std::endl;
+    return -1;
+  }
+
   SpaceInvadersGame game;
+  if (soak)
+  {
+    game.soak(soak_minutes);
+  }
+
   if (!game.init())
   {
     return -1;
@@ -13,4 +47,4 @@ int main()
 
   std::cout << "Exiting Game!" << std::endl;
   return 0;
-}
\ No newline at end of file
+}
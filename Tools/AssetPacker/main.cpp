@@ -0,0 +1,168 @@
+/**
+ *  Packs a GameData folder into a single archive.
+ *  Usage: AssetPacker <GameData folder> <output archive> [generated folder]...
+ *
+ *  Every regular file below the folder is stored, keyed by the hash of
+ *  its path relative to the folder, along with the hash of its contents.
+ *  Files generated by the build, such as the sprite atlas, are kept out
+ *  of the source tree in folders laid out like GameData. Each one given
+ *  is packed as if it were part of GameData, replacing any file there
+ *  with the same path.
+ *  The index is sorted by path hash and each file starts on a 16 byte
+ *  boundary so the game can map the archive and hand out pointers to its
+ *  contents without copying.
+ *  @see AssetArchive
+ */
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Utility/AssetArchive.h"
+#include "Utility/Hash.h"
+
+namespace fs = std::filesystem;
+
+struct PackedFile
+{
+  std::string path;
+  fs::path source;
+  ArchiveEntry entry;
+};
+
+static uint64_t alignUp(uint64_t value)
+{
+  return (value + ARCHIVE_ALIGNMENT - 1) & ~(ARCHIVE_ALIGNMENT - 1);
+}
+
+static void collectFiles(const fs::path& root, std::vector<PackedFile>& files)
+{
+  for (const auto& item : fs::recursive_directory_iterator(root))
+  {
+    if (!item.is_regular_file())
+    {
+      continue;
+    }
+
+    PackedFile file;
+    file.path = fs::relative(item.path(), root).generic_string();
+    file.source = item.path();
+    file.entry.path_hash = hashPath(file.path);
+    file.entry.size = static_cast<uint64_t>(item.file_size());
+
+    auto packed =
+      std::find_if(files.begin(), files.end(), [&](const auto& other) {
+        return other.path == file.path;
+      });
+    if (packed != files.end())
+    {
+      *packed = file;
+    }
+    else
+    {
+      files.push_back(file);
+    }
+  }
+}
+
+static bool hasCollisions(const std::vector<PackedFile>& files)
+{
+  for (size_t i = 1; i < files.size(); i++)
+  {
+    if (files[i].entry.path_hash == files[i - 1].entry.path_hash)
+    {
+      std::cerr << "hash collision: " << files[i].path << " and "
+                << files[i - 1].path << std::endl;
+      return true;
+    }
+  }
+  return false;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "usage: AssetPacker <GameData folder> <output archive> "
+                 "[generated folder]..."
+              << std::endl;
+    return 1;
+  }
+
+  std::vector<PackedFile> files;
+  collectFiles(argv[1], files);
+  for (int i = 3; i < argc; i++)
+  {
+    collectFiles(argv[i], files);
+  }
+
+  std::sort(files.begin(), files.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.entry.path_hash < rhs.entry.path_hash;
+  });
+  if (hasCollisions(files))
+  {
+    return 1;
+  }
+
+  ArchiveHeader header;
+  std::copy(ARCHIVE_MAGIC, ARCHIVE_MAGIC + 4, header.magic);
+  header.version = ARCHIVE_VERSION;
+  header.entry_count = static_cast<uint32_t>(files.size());
+
+  uint64_t offset =
+    alignUp(sizeof(ArchiveHeader) + files.size() * sizeof(ArchiveEntry));
+  for (auto& file : files)
+  {
+    file.entry.offset = offset;
+    offset = alignUp(offset + file.entry.size);
+  }
+
+  std::ofstream archive(argv[2], std::ios::binary | std::ios::trunc);
+  if (!archive)
+  {
+    std::cerr << "unable to create " << argv[2] << std::endl;
+    return 1;
+  }
+
+  // the index is written again once every file's contents are hashed
+  archive.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  for (const auto& file : files)
+  {
+    archive.write(reinterpret_cast<const char*>(&file.entry),
+                  sizeof(file.entry));
+  }
+
+  std::vector<char> buffer;
+  for (auto& file : files)
+  {
+    buffer.assign(static_cast<size_t>(file.entry.size), 0);
+    std::ifstream source(file.source, std::ios::binary);
+    auto size = static_cast<std::streamsize>(buffer.size());
+    if (!source.read(buffer.data(), size))
+    {
+      std::cerr << "unable to read " << file.source << std::endl;
+      return 1;
+    }
+
+    // pad up to the entry's aligned offset before writing it
+    auto position = static_cast<uint64_t>(archive.tellp());
+    std::fill_n(std::ostreambuf_iterator<char>(archive),
+                file.entry.offset - position,
+                '\0');
+    archive.write(buffer.data(), size);
+    file.entry.content_hash = hashBytes(buffer.data(), buffer.size());
+  }
+
+  archive.seekp(sizeof(header));
+  for (const auto& file : files)
+  {
+    archive.write(reinterpret_cast<const char*>(&file.entry),
+                  sizeof(file.entry));
+  }
+
+  std::cout << "packed " << files.size() << " files into " << argv[2] << " ("
+            << offset << " bytes)" << std::endl;
+  return archive ? 0 : 1;
+}
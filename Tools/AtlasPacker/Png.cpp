@@ -0,0 +1,240 @@
+#include "Png.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+#include <zlib.h>
+
+static uint32_t readBigEndian(const unsigned char* bytes)
+{
+  return (static_cast<uint32_t>(bytes[0]) << 24) |
+         (static_cast<uint32_t>(bytes[1]) << 16) |
+         (static_cast<uint32_t>(bytes[2]) << 8) |
+         static_cast<uint32_t>(bytes[3]);
+}
+
+static int paeth(int a, int b, int c)
+{
+  int p = a + b - c;
+  int pa = std::abs(p - a);
+  int pb = std::abs(p - b);
+  int pc = std::abs(p - c);
+  if (pa <= pb && pa <= pc)
+  {
+    return a;
+  }
+  return pb <= pc ? b : c;
+}
+
+/**
+ *   @brief   Reverses the PNG scanline filters in place.
+ *   @details Each row is prefixed by its filter type. The filtered data
+ *            is replaced by raw rows, packed without the prefix bytes.
+ *   @return  False if a row uses an unknown filter.
+ */
+static bool
+unfilter(std::vector<unsigned char>& data, int width, int height, int bpp)
+{
+  size_t stride = static_cast<size_t>(width) * bpp;
+  std::vector<unsigned char> rows(stride * height);
+  for (int y = 0; y < height; y++)
+  {
+    const unsigned char* src = &data[y * (stride + 1)];
+    unsigned char* row = &rows[y * stride];
+    const unsigned char* prev = y > 0 ? row - stride : nullptr;
+    int filter = *src++;
+
+    for (size_t x = 0; x < stride; x++)
+    {
+      int left = x >= static_cast<size_t>(bpp) ? row[x - bpp] : 0;
+      int up = prev ? prev[x] : 0;
+      int up_left = prev && x >= static_cast<size_t>(bpp) ? prev[x - bpp] : 0;
+
+      int predictor = 0;
+      switch (filter)
+      {
+        case 0:
+          break;
+        case 1:
+          predictor = left;
+          break;
+        case 2:
+          predictor = up;
+          break;
+        case 3:
+          predictor = (left + up) / 2;
+          break;
+        case 4:
+          predictor = paeth(left, up, up_left);
+          break;
+        default:
+          return false;
+      }
+      row[x] = static_cast<unsigned char>(src[x] + predictor);
+    }
+  }
+
+  data.swap(rows);
+  return true;
+}
+
+std::string decodePng(const std::string& file_path, Image& image)
+{
+  std::ifstream file(file_path, std::ios::binary);
+  std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)),
+                                   std::istreambuf_iterator<char>());
+
+  const unsigned char signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+  if (bytes.size() < 8 || std::memcmp(bytes.data(), signature, 8) != 0)
+  {
+    return "not a png";
+  }
+
+  int bit_depth = 0;
+  int colour_type = 0;
+  int interlace = 0;
+  std::vector<unsigned char> compressed;
+  std::vector<unsigned char> palette;
+  std::vector<unsigned char> palette_alpha;
+
+  size_t pos = 8;
+  while (pos + 12 <= bytes.size())
+  {
+    uint32_t length = readBigEndian(&bytes[pos]);
+    const unsigned char* type = &bytes[pos + 4];
+    const unsigned char* chunk = &bytes[pos + 8];
+    if (pos + 12 + length > bytes.size())
+    {
+      return "truncated chunk";
+    }
+
+    if (std::memcmp(type, "IHDR", 4) == 0 && length >= 13)
+    {
+      image.width = static_cast<int>(readBigEndian(chunk));
+      image.height = static_cast<int>(readBigEndian(chunk + 4));
+      bit_depth = chunk[8];
+      colour_type = chunk[9];
+      interlace = chunk[12];
+    }
+    else if (std::memcmp(type, "PLTE", 4) == 0)
+    {
+      palette.assign(chunk, chunk + length);
+    }
+    else if (std::memcmp(type, "tRNS", 4) == 0)
+    {
+      palette_alpha.assign(chunk, chunk + length);
+    }
+    else if (std::memcmp(type, "IDAT", 4) == 0)
+    {
+      compressed.insert(compressed.end(), chunk, chunk + length);
+    }
+    else if (std::memcmp(type, "IEND", 4) == 0)
+    {
+      break;
+    }
+    pos += 12 + length;
+  }
+
+  if (bit_depth != 8 || interlace != 0)
+  {
+    return "only 8 bit, non-interlaced pngs are supported";
+  }
+
+  int channels = 0;
+  switch (colour_type)
+  {
+    case 0:
+      channels = 1;
+      break;
+    case 2:
+      channels = 3;
+      break;
+    case 3:
+      channels = 1;
+      break;
+    case 4:
+      channels = 2;
+      break;
+    case 6:
+      channels = 4;
+      break;
+    default:
+      return "unknown colour type";
+  }
+
+  auto raw_size = static_cast<uLongf>(image.height) *
+                  (1 + static_cast<uLongf>(image.width) * channels);
+  std::vector<unsigned char> raw(raw_size);
+  if (uncompress(raw.data(),
+                 &raw_size,
+                 compressed.data(),
+                 static_cast<uLong>(compressed.size())) != Z_OK ||
+      raw_size != raw.size())
+  {
+    return "corrupt image data";
+  }
+
+  if (!unfilter(raw, image.width, image.height, channels))
+  {
+    return "unknown filter";
+  }
+
+  size_t pixel_count = static_cast<size_t>(image.width) * image.height;
+  image.pixels.resize(pixel_count * 4);
+  for (size_t i = 0; i < pixel_count; i++)
+  {
+    const unsigned char* src = &raw[i * channels];
+    unsigned char* dst = &image.pixels[i * 4];
+    switch (colour_type)
+    {
+      case 0:
+      case 4:
+        dst[0] = dst[1] = dst[2] = src[0];
+        dst[3] = colour_type == 4 ? src[1] : 255;
+        break;
+      case 2:
+      case 6:
+        std::memcpy(dst, src, 3);
+        dst[3] = colour_type == 6 ? src[3] : 255;
+        break;
+      case 3:
+        if (static_cast<size_t>(src[0]) * 3 + 2 >= palette.size())
+        {
+          return "palette index out of range";
+        }
+        std::memcpy(dst, &palette[src[0] * 3], 3);
+        dst[3] = src[0] < palette_alpha.size() ? palette_alpha[src[0]] : 255;
+        break;
+      default:
+        break;
+    }
+  }
+  return "";
+}
+
+bool writeTga(const std::string& file_path, const Image& image)
+{
+  unsigned char header[18] = {};
+  header[2] = 2; // uncompressed true colour
+  header[12] = static_cast<unsigned char>(image.width & 0xFF);
+  header[13] = static_cast<unsigned char>((image.width >> 8) & 0xFF);
+  header[14] = static_cast<unsigned char>(image.height & 0xFF);
+  header[15] = static_cast<unsigned char>((image.height >> 8) & 0xFF);
+  header[16] = 32;   // bits per pixel
+  header[17] = 0x28; // 8 alpha bits, top left origin
+
+  std::vector<unsigned char> bgra(image.pixels);
+  for (size_t i = 0; i < bgra.size(); i += 4)
+  {
+    std::swap(bgra[i], bgra[i + 2]);
+  }
+
+  std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(bgra.data()),
+             static_cast<std::streamsize>(bgra.size()));
+  return static_cast<bool>(file);
+}
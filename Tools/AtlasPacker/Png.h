@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include <vector>
+
+/**
+ *  A decoded image, always 8 bit RGBA with rows stored top to bottom.
+ */
+struct Image
+{
+  int width = 0;
+  int height = 0;
+  std::vector<unsigned char> pixels;
+};
+
+/**
+ *  Decodes a non-interlaced, 8 bit per channel PNG.
+ *  Greyscale, RGB, palette and their alpha variants are supported, which
+ *  covers every image in the bundled sprite packs.
+ *  @param [in] file_path The PNG to load
+ *  @param [out] image The decoded RGBA image
+ *  @return an empty string on success, otherwise the reason it failed
+ */
+std::string decodePng(const std::string& file_path, Image& image);
+
+/**
+ *  Writes an uncompressed 32 bit TGA, top left origin.
+ *  @param [in] file_path The file to write
+ *  @param [in] image The image to store
+ *  @return true if the file was written
+ */
+bool writeTga(const std::string& file_path, const Image& image);
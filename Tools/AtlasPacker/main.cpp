@@ -0,0 +1,408 @@
+/**
+ *  Packs the game's sprite images onto texture atlases.
+ *  Usage: AtlasPacker <GameData folder> <images folder> <output folder>
+ *
+ *  Every PNG below <GameData>/<images> is packed with a skyline bin
+ *  packer onto square, power of two pages no larger than MAX_PAGE_SIZE,
+ *  using as few pages as possible. Each image is surrounded by PADDING
+ *  pixels with its edge pixels extruded into them, so filtering never
+ *  samples a neighbour. The pages and a binary index are written below
+ *  <output>, at the same paths they are read from in GameData, along with
+ *  a 1 bit collision mask of each image. The output folder belongs to the
+ *  build, so packing never writes into the source tree.
+ *  @see SpriteAtlas
+ *  @see MaskLibrary
+ */
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Png.h"
+#include "Utility/CollisionMask.h"
+#include "Utility/Hash.h"
+#include "Utility/SpriteAtlas.h"
+
+namespace fs = std::filesystem;
+
+const int MIN_PAGE_SIZE = 64;
+const int MAX_PAGE_SIZE = 2048;
+const int PADDING = 2;
+// the lowest alpha counted as solid in a collision mask
+const int MASK_ALPHA_THRESHOLD = 128;
+
+struct SourceImage
+{
+  std::string path;
+  Image image;
+  AtlasRegion region;
+  bool packed = false;
+};
+
+struct SkylineNode
+{
+  int x = 0;
+  int y = 0;
+  int width = 0;
+};
+
+/**
+ *  A skyline bin packer.
+ *  Tracks the top edge of everything placed so far as a list of
+ *  horizontal segments and places each rectangle where it would leave
+ *  the lowest top edge.
+ */
+class Skyline
+{
+ public:
+  explicit Skyline(int page_size) : size(page_size)
+  {
+    nodes.push_back(SkylineNode{ 0, 0, page_size });
+  }
+
+  bool insert(int width, int height, int& x, int& y)
+  {
+    int best_index = -1;
+    int best_top = size + 1;
+    int best_width = size + 1;
+
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+      int top = 0;
+      if (fits(i, width, height, top) &&
+          (top + height < best_top ||
+           (top + height == best_top && nodes[i].width < best_width)))
+      {
+        best_index = static_cast<int>(i);
+        best_top = top + height;
+        best_width = nodes[i].width;
+      }
+    }
+
+    if (best_index < 0)
+    {
+      return false;
+    }
+
+    x = nodes[best_index].x;
+    y = best_top - height;
+    place(static_cast<size_t>(best_index), x, best_top, width);
+    return true;
+  }
+
+ private:
+  bool fits(size_t index, int width, int height, int& top) const
+  {
+    int x = nodes[index].x;
+    if (x + width > size)
+    {
+      return false;
+    }
+
+    top = 0;
+    int remaining = width;
+    for (size_t i = index; remaining > 0; i++)
+    {
+      if (i >= nodes.size())
+      {
+        return false;
+      }
+      top = std::max(top, nodes[i].y);
+      remaining -= nodes[i].width;
+    }
+    return top + height <= size;
+  }
+
+  void place(size_t index, int x, int top, int width)
+  {
+    nodes.insert(nodes.begin() + static_cast<long>(index),
+                 SkylineNode{ x, top, width });
+
+    // trim the segments now covered by the new one
+    for (size_t i = index + 1; i < nodes.size();)
+    {
+      int covered = x + width - nodes[i].x;
+      if (covered <= 0)
+      {
+        break;
+      }
+      if (covered < nodes[i].width)
+      {
+        nodes[i].x += covered;
+        nodes[i].width -= covered;
+        break;
+      }
+      nodes.erase(nodes.begin() + static_cast<long>(i));
+    }
+
+    // merge neighbouring segments at the same height
+    for (size_t i = 0; i + 1 < nodes.size();)
+    {
+      if (nodes[i].y == nodes[i + 1].y)
+      {
+        nodes[i].width += nodes[i + 1].width;
+        nodes.erase(nodes.begin() + static_cast<long>(i) + 1);
+      }
+      else
+      {
+        i++;
+      }
+    }
+  }
+
+  int size = 0;
+  std::vector<SkylineNode> nodes;
+};
+
+static std::vector<SourceImage>
+loadImages(const fs::path& game_data, const fs::path& images)
+{
+  std::vector<SourceImage> sources;
+  fs::path folder = game_data / images;
+  for (const auto& item : fs::recursive_directory_iterator(folder))
+  {
+    if (!item.is_regular_file() || item.path().extension() != ".png")
+    {
+      continue;
+    }
+
+    SourceImage source;
+    source.path = fs::relative(item.path(), game_data).generic_string();
+    std::string error = decodePng(item.path().string(), source.image);
+    if (!error.empty())
+    {
+      std::cerr << "skipping " << source.path << ": " << error << std::endl;
+      continue;
+    }
+    source.region.path_hash = hashPath(source.path);
+    sources.push_back(std::move(source));
+  }
+
+  // tallest first packs a skyline most tightly
+  std::stable_sort(
+    sources.begin(), sources.end(), [](const auto& lhs, const auto& rhs) {
+      return lhs.image.height > rhs.image.height;
+    });
+  return sources;
+}
+
+/**
+ *   @brief   Packs as many unpacked images as possible onto one page.
+ *   @details Tries every power of two size and uses the smallest one
+ *            that holds all of the remaining images. If none do, the
+ *            largest page is filled as far as it will go.
+ *   @return  The size of the page used.
+ */
+static int packPage(std::vector<SourceImage>& sources, uint32_t page)
+{
+  int page_size = MIN_PAGE_SIZE;
+  for (; page_size <= MAX_PAGE_SIZE; page_size *= 2)
+  {
+    Skyline skyline(page_size);
+    bool all_fit = true;
+    for (auto& source : sources)
+    {
+      int x = 0;
+      int y = 0;
+      if (!source.packed &&
+          !skyline.insert(source.image.width + PADDING * 2,
+                          source.image.height + PADDING * 2,
+                          x,
+                          y))
+      {
+        all_fit = false;
+        break;
+      }
+    }
+
+    if (all_fit)
+    {
+      break;
+    }
+  }
+  page_size = std::min(page_size, MAX_PAGE_SIZE);
+
+  Skyline skyline(page_size);
+  for (auto& source : sources)
+  {
+    int x = 0;
+    int y = 0;
+    if (!source.packed &&
+        skyline.insert(source.image.width + PADDING * 2,
+                       source.image.height + PADDING * 2,
+                       x,
+                       y))
+    {
+      source.packed = true;
+      source.region.page = page;
+      source.region.x = static_cast<uint32_t>(x + PADDING);
+      source.region.y = static_cast<uint32_t>(y + PADDING);
+      source.region.width = static_cast<uint32_t>(source.image.width);
+      source.region.height = static_cast<uint32_t>(source.image.height);
+    }
+  }
+  return page_size;
+}
+
+/**
+ *   @brief   Copies a page's images into its texture.
+ *   @details The outermost pixels of each image are repeated out into
+ *            the padding around it.
+ *   @return  void
+ */
+static void
+drawPage(const std::vector<SourceImage>& sources, uint32_t page, Image& atlas)
+{
+  atlas.pixels.assign(static_cast<size_t>(atlas.width) * atlas.height * 4, 0);
+  for (const auto& source : sources)
+  {
+    if (!source.packed || source.region.page != page)
+    {
+      continue;
+    }
+
+    const Image& image = source.image;
+    for (int y = -PADDING; y < image.height + PADDING; y++)
+    {
+      int src_y = std::clamp(y, 0, image.height - 1);
+      for (int x = -PADDING; x < image.width + PADDING; x++)
+      {
+        int src_x = std::clamp(x, 0, image.width - 1);
+        size_t dst_x = source.region.x + x;
+        size_t dst_y = source.region.y + y;
+        std::copy_n(&image.pixels[(src_y * image.width + src_x) * 4],
+                    4,
+                    &atlas.pixels[(dst_y * atlas.width + dst_x) * 4]);
+      }
+    }
+  }
+}
+
+/**
+ *   @brief   Writes the collision mask file.
+ *   @details Masks are kept at each image's own size and stored in the
+ *            same order as the atlas regions, sorted by path hash.
+ *   @return  True if the file was written.
+ */
+static bool writeMasks(const fs::path& output,
+                       const std::vector<SourceImage>& sources)
+{
+  std::vector<const SourceImage*> sorted;
+  for (const auto& source : sources)
+  {
+    sorted.push_back(&source);
+  }
+  std::sort(sorted.begin(), sorted.end(), [](const auto* lhs, const auto* rhs) {
+    return lhs->region.path_hash < rhs->region.path_hash;
+  });
+
+  std::vector<MaskRecord> records;
+  std::vector<uint64_t> words;
+  for (const auto* source : sorted)
+  {
+    CollisionMask mask;
+    mask.fromAlpha(source->image.pixels.data(),
+                   source->image.width,
+                   source->image.height,
+                   MASK_ALPHA_THRESHOLD);
+
+    MaskRecord record;
+    record.path_hash = source->region.path_hash;
+    record.width = static_cast<uint32_t>(mask.width());
+    record.height = static_cast<uint32_t>(mask.height());
+    record.first_word = words.size();
+    records.push_back(record);
+    words.insert(words.end(), mask.words().begin(), mask.words().end());
+  }
+
+  MaskHeader header;
+  std::copy(MASK_MAGIC, MASK_MAGIC + 4, header.magic);
+  header.version = MASK_VERSION;
+  header.mask_count = static_cast<uint32_t>(records.size());
+
+  std::ofstream file(output / MASK_FILE, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(records.data()),
+             static_cast<std::streamsize>(records.size() * sizeof(MaskRecord)));
+  file.write(reinterpret_cast<const char*>(words.data()),
+             static_cast<std::streamsize>(words.size() * sizeof(uint64_t)));
+  return static_cast<bool>(file);
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc != 4)
+  {
+    std::cerr << "usage: AtlasPacker <GameData folder> <images folder> "
+                 "<output folder>"
+              << std::endl;
+    return 1;
+  }
+
+  fs::path game_data = argv[1];
+  fs::path output = argv[3];
+  std::vector<SourceImage> sources = loadImages(game_data, argv[2]);
+  fs::create_directories((output / ATLAS_INDEX_FILE).parent_path());
+
+  uint32_t page = 0;
+  while (std::any_of(sources.begin(), sources.end(), [](const auto& source) {
+    return !source.packed;
+  }))
+  {
+    Image atlas;
+    atlas.width = atlas.height = packPage(sources, page);
+    if (std::none_of(sources.begin(), sources.end(), [page](const auto& s) {
+          return s.packed && s.region.page == page;
+        }))
+    {
+      std::cerr << "an image is larger than the maximum page size"
+                << std::endl;
+      return 1;
+    }
+
+    drawPage(sources, page, atlas);
+    if (!writeTga((output / atlasPageFile(page)).string(), atlas))
+    {
+      std::cerr << "unable to write " << atlasPageFile(page) << std::endl;
+      return 1;
+    }
+    std::cout << atlasPageFile(page) << ": " << atlas.width << "x"
+              << atlas.height << std::endl;
+    page++;
+  }
+
+  std::vector<AtlasRegion> regions;
+  for (const auto& source : sources)
+  {
+    regions.push_back(source.region);
+  }
+  std::sort(
+    regions.begin(), regions.end(), [](const auto& lhs, const auto& rhs) {
+      return lhs.path_hash < rhs.path_hash;
+    });
+
+  AtlasHeader header;
+  std::copy(ATLAS_MAGIC, ATLAS_MAGIC + 4, header.magic);
+  header.version = ATLAS_VERSION;
+  header.page_count = page;
+  header.region_count = static_cast<uint32_t>(regions.size());
+
+  std::ofstream index(output / ATLAS_INDEX_FILE,
+                      std::ios::binary | std::ios::trunc);
+  index.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  auto regions_size = regions.size() * sizeof(AtlasRegion);
+  index.write(reinterpret_cast<const char*>(regions.data()),
+              static_cast<std::streamsize>(regions_size));
+
+  if (!writeMasks(output, sources))
+  {
+    std::cerr << "unable to write " << MASK_FILE << std::endl;
+    return 1;
+  }
+
+  std::cout << "packed " << regions.size() << " images onto " << page
+            << " page(s)" << std::endl;
+  return index ? 0 : 1;
+}
@@ -0,0 +1,172 @@
+/**
+ *  Measures how fast batches of a wave can be simulated.
+ *  Usage: SimulationBench <wave file> [environments] [steps] [threads]
+ *
+ *  The wave is played in an EnvironmentBatch with random actions, first
+ *  on one thread and then shared across a WorkerPool. Each run's
+ *  observations, rewards and outcomes are hashed every step, so the two
+ *  runs must give the same hash; the tool fails if they do not.
+ *  @see EnvironmentBatch
+ */
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "EnvironmentBatch.h"
+#include "Simulation.h"
+#include "Utility/Hash.h"
+#include "Utility/Wave.h"
+#include "Utility/WorkerPool.h"
+
+// the game's resolution, see SpaceInvadersGame::setupResolution
+const float PLAY_WIDTH = 640;
+const float PLAY_HEIGHT = 920;
+const uint64_t BENCH_SEED = 1;
+
+struct BenchResult
+{
+  uint64_t hash = FNV_OFFSET_BASIS;
+  uint64_t episodes = 0;
+  double seconds = 0;
+};
+
+static bool loadWave(const std::string& file_path, wave_definition& wave)
+{
+  std::ifstream file(file_path, std::ios::binary);
+  if (!file)
+  {
+    std::cerr << "unable to read " << file_path << std::endl;
+    return false;
+  }
+
+  std::string text((std::istreambuf_iterator<char>(file)),
+                   std::istreambuf_iterator<char>());
+  std::string error = parseWave(text.data(), text.size(), wave);
+  if (!error.empty())
+  {
+    std::cerr << file_path << ": " << error << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ *   @brief   Plays a batch for a number of steps.
+ *   @details Actions come from one generator, drawn on the calling
+ *            thread, so every run plays the same actions. Only stepping
+ *            is timed.
+ *   @return  The hash of everything the batch wrote, and how long it
+ *            took.
+ */
+static BenchResult run(const sim_layout& layout,
+                       const sim_state& start,
+                       size_t environments,
+                       size_t steps,
+                       WorkerPool* workers)
+{
+  batch_settings settings;
+  settings.environments = environments;
+  settings.seed = BENCH_SEED;
+
+  EnvironmentBatch batch;
+  batch.reset(settings, layout, start);
+
+  std::vector<uint8_t> actions(environments);
+  std::vector<float> observations(environments * batch.observationSize());
+  std::vector<float> rewards(environments);
+  std::vector<uint8_t> outcomes(environments);
+
+  BenchResult result;
+  uint32_t random = 1;
+  std::chrono::steady_clock::duration elapsed{};
+  for (size_t step = 0; step < steps; step++)
+  {
+    for (auto& action : actions)
+    {
+      action = static_cast<uint8_t>(nextRandom(random) & 7);
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    batch.step(actions.data(),
+               observations.data(),
+               rewards.data(),
+               outcomes.data(),
+               workers);
+    elapsed += std::chrono::steady_clock::now() - begin;
+
+    result.hash = hashBytes(observations.data(),
+                            observations.size() * sizeof(float),
+                            result.hash);
+    result.hash =
+      hashBytes(rewards.data(), rewards.size() * sizeof(float), result.hash);
+    result.hash = hashBytes(outcomes.data(), outcomes.size(), result.hash);
+    for (uint8_t outcome : outcomes)
+    {
+      result.episodes += outcome != ENV_RUNNING ? 1 : 0;
+    }
+  }
+
+  result.seconds = std::chrono::duration<double>(elapsed).count();
+  return result;
+}
+
+static void report(const std::string& name,
+                   const BenchResult& result,
+                   size_t environments,
+                   size_t steps)
+{
+  double frames = static_cast<double>(environments) * steps;
+  std::cout << name << ": " << static_cast<uint64_t>(frames / result.seconds)
+            << " frames/s, " << result.episodes << " episodes, hash "
+            << std::hex << result.hash << std::dec << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2 || argc > 5)
+  {
+    std::cerr << "usage: SimulationBench <wave file> [environments] [steps] "
+                 "[threads]"
+              << std::endl;
+    return 1;
+  }
+
+  size_t environments = argc > 2 ? std::stoul(argv[2]) : 1024;
+  size_t steps = argc > 3 ? std::stoul(argv[3]) : 600;
+  size_t threads =
+    argc > 4 ? std::stoul(argv[4]) : std::thread::hardware_concurrency();
+  threads = threads > 0 ? threads : 1;
+
+  wave_definition wave;
+  if (!loadWave(argv[1], wave))
+  {
+    return 1;
+  }
+
+  sim_layout layout;
+  sim_state start;
+  startWave(wave, PLAY_WIDTH, PLAY_HEIGHT, layout, start);
+
+  BenchResult single = run(layout, start, environments, steps, nullptr);
+  report("1 thread", single, environments, steps);
+
+  WorkerPool workers;
+  workers.start(threads - 1);
+  BenchResult shared = run(layout, start, environments, steps, &workers);
+  report("worker pool of " + std::to_string(workers.threads()),
+         shared,
+         environments,
+         steps);
+
+  if (shared.hash != single.hash)
+  {
+    std::cerr << "threaded results differ from the single thread"
+              << std::endl;
+    return 1;
+  }
+  return 0;
+}